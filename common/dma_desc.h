@@ -0,0 +1,111 @@
+// DESCRIPTOR DMA: TRUYỀN 2D / 3D CÓ BƯỚC (STRIDE)
+//
+// Trước đây mỗi hàm dma_* chép từng byte trong 3 vòng lặp lồng nhau và chỉ tính băng thông.
+// DMA thật được lập trình bằng descriptor: địa chỉ gốc + số phần tử / bước của từng chiều,
+// mỗi descriptor tốn 1 lần khởi tạo (SIM_DMA_SETUP chu kỳ, common/sim_core.h).
+//
+// 1 descriptor:
+//   - chiều 0: count[0] byte liền nhau (cả nguồn và đích)
+//   - chiều 1, 2: lặp count[1], count[2] lần với bước src_stride / dst_stride (byte)
+// Vd cửa sổ IFM NHWC: {nc, KERNEL_W, KERNEL_H} với bước nguồn {., INPUT_C, INPUT_W*INPUT_C}.
+// Các chiều liền nhau ở cả 2 phía được gộp lại trước khi chép -> memcpy dài nhất có thể.
+// Mỗi đoạn liền nhau báo cho GLB / mô hình DRAM bằng glb_read (thay cho từng byte).
+// Số descriptor của giao dịch đang gom được sim_dma_load lấy ra bằng dma_desc_take.
+#ifndef DMA_DESC_H
+#define DMA_DESC_H
+
+#include <stdint.h>
+#include <string.h>
+#include "glb_model.h"
+
+typedef struct {
+    int region;                 // Vùng DRAM nguồn (DRAM_IFM / DRAM_WEIGHT)
+    const int8_t* src;          // Mảng DRAM của vùng
+    long long src_off;          // Offset (byte) của phần tử đầu trong vùng
+    int8_t* dst;                // Phần tử đầu trên buffer on-chip
+    int count[3];               // count[0]: số byte liền nhau; count[1], count[2]: số lần lặp
+    long long src_stride[3];    // Bước nguồn (byte) của chiều 1, 2 ([0] không dùng)
+    long long dst_stride[3];    // Bước đích (byte) của chiều 1, 2 ([0] không dùng)
+} dma_desc;
+
+static int dma_desc_pending = 0;                // Descriptor của giao dịch đang gom
+static unsigned long long dma_desc_issued = 0;  // Tổng số descriptor
+
+// Gộp các chiều liền nhau ở cả nguồn và đích (chiều 1 vào chiều 0, chiều 2 vào chiều 1)
+static inline void dma_desc_normalize(dma_desc* d) {
+    for (int k = 0; k < 2; k++) {
+        // Chiều 1 chỉ có 1 phần tử: dời chiều 2 xuống
+        if (d->count[1] == 1 && d->count[2] > 1) {
+            d->count[1] = d->count[2];
+            d->src_stride[1] = d->src_stride[2];
+            d->dst_stride[1] = d->dst_stride[2];
+            d->count[2] = 1;
+        }
+        if (d->count[1] > 1 && d->src_stride[1] == d->count[0] && d->dst_stride[1] == d->count[0]) {
+            d->count[0] *= d->count[1];
+            d->count[1] = d->count[2];
+            d->src_stride[1] = d->src_stride[2];
+            d->dst_stride[1] = d->dst_stride[2];
+            d->count[2] = 1;
+        }
+        if (d->count[2] > 1 && d->src_stride[2] == d->count[1] * d->src_stride[1] &&
+            d->dst_stride[2] == d->count[1] * d->dst_stride[1]) {
+            d->count[1] *= d->count[2];
+            d->count[2] = 1;
+        }
+    }
+}
+
+// Thực hiện 1 descriptor: chép có bước từ DRAM vào buffer on-chip. Trả về số byte đã chép
+static inline long long dma_desc_run(dma_desc d) {
+    if (d.count[0] <= 0 || d.count[1] <= 0 || d.count[2] <= 0) return 0;
+    long long bytes = (long long)d.count[0] * d.count[1] * d.count[2];
+    dma_desc_normalize(&d);
+    const int8_t* s2 = d.src + d.src_off;
+    long long off2 = d.src_off;
+    int8_t* t2 = d.dst;
+    for (int i2 = 0; i2 < d.count[2]; i2++) {
+        const int8_t* s = s2;
+        long long off = off2;
+        int8_t* t = t2;
+        if (d.count[0] == 1) {
+            // Gom từng byte (vd weight: bước OUTPUT_F giữa các channel)
+            for (int i1 = 0; i1 < d.count[1]; i1++) {
+                glb_read(d.region, off, 1);
+                *t = *s;
+                s += d.src_stride[1];
+                off += d.src_stride[1];
+                t += d.dst_stride[1];
+            }
+        } else {
+            for (int i1 = 0; i1 < d.count[1]; i1++) {
+                glb_read(d.region, off, d.count[0]);
+                memcpy(t, s, d.count[0]);
+                s += d.src_stride[1];
+                off += d.src_stride[1];
+                t += d.dst_stride[1];
+            }
+        }
+        s2 += d.src_stride[2];
+        off2 += d.src_stride[2];
+        t2 += d.dst_stride[2];
+    }
+    dma_desc_pending++;
+    dma_desc_issued++;
+    return bytes;
+}
+
+// Descriptor có dữ liệu đã được chép riêng (vd U int64 của Winograd, khác kích thước phần tử ở DRAM): chỉ đếm
+static inline void dma_desc_note() {
+    dma_desc_pending++;
+    dma_desc_issued++;
+}
+
+// Lấy số descriptor của giao dịch vừa gom (ít nhất 1: giao dịch không có descriptor vẫn phải khởi tạo)
+static inline int dma_desc_take() {
+    int n = dma_desc_pending;
+    dma_desc_pending = 0;
+    return (n > 0) ? n : 1;
+}
+
+#endif // DMA_DESC_H
@@ -0,0 +1,162 @@
+// MÔ HÌNH THỜI GIAN DRAM: BURST + ROW BUFFER
+//
+// Mô hình cũ: DMA = ceil(bytes / DRAM_BUS_WIDTH_BYTES), tức là coi mọi byte liền nhau.
+// Thực tế DMA gom (gather) từng byte theo channel từ mảng NHWC, weight lấy với bước
+// INPUT_C*OUTPUT_F -> mỗi lần đọc kéo theo cả 1 burst, và đổi hàng DRAM tốn precharge/activate.
+//
+// Mô hình này (bật bằng SIM_DRAM=1):
+//   - Mỗi lần đọc phần tử trong 1 giao dịch DMA ghi lại địa chỉ (dram_touch)
+//   - Cuối giao dịch (dram_flush): gom các địa chỉ thành tập burst KHÁC NHAU, sắp theo địa chỉ
+//   - Mỗi burst: bank = hàng % DRAM_NUM_BANKS
+//       + hàng đang mở (row hit)       : chỉ truyền dữ liệu
+//       + bank chưa mở hàng nào        : tRCD + truyền
+//       + đang mở hàng khác (conflict) : tRP + tRCD + truyền
+//   - Mỗi giao dịch trả thêm tCL 1 lần (các burst sau được pipeline)
+//
+// Thống kê: số burst, row hit/empty/conflict, byte có ích / byte trên bus (hiệu suất bus).
+// Các hằng số tính theo chu kỳ của accelerator (~100 MHz, LPDDR4: tRCD ~ tRP ~ 18 ns).
+#ifndef DRAM_MODEL_H
+#define DRAM_MODEL_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DRAM_BURST_BYTES 32     // BL16 x 16 bit
+#define DRAM_ROW_BYTES 2048     // Kích thước 1 hàng (page) / bank
+#define DRAM_NUM_BANKS 8
+#define DRAM_TRCD 2             // Activate -> đọc
+#define DRAM_TRP 2              // Precharge
+#define DRAM_TCL 2              // CAS latency (1 lần / giao dịch)
+
+// Vùng địa chỉ (mỗi vùng bắt đầu ở 1 mốc 256 MB riêng, địa chỉ tính theo byte)
+enum { DRAM_IFM, DRAM_WEIGHT, DRAM_OFM };
+#define DRAM_REGION_BYTES (256LL << 20)
+
+typedef struct {
+    int enabled;
+    int bus_bytes;                      // Độ rộng bus (byte / chu kỳ)
+    long long* bursts;                  // Burst id của giao dịch đang gom
+    int n, cap;
+    long long open_row[DRAM_NUM_BANKS]; // -1 = bank chưa mở hàng nào
+    unsigned long long useful_bytes;    // Byte thật sự cần
+    unsigned long long burst_count;
+    unsigned long long row_hits, row_empty, row_conflicts;
+    unsigned long long transactions, cycles;
+} dram_model;
+
+static dram_model dram;
+
+static inline void dram_model_init(int bus_bytes) {
+    const char* env = getenv("SIM_DRAM");
+    free(dram.bursts);
+    memset(&dram, 0, sizeof(dram));
+    dram.enabled = (env && atoi(env) != 0);
+    dram.bus_bytes = bus_bytes;
+    for (int b = 0; b < DRAM_NUM_BANKS; b++) dram.open_row[b] = -1;
+}
+
+// Ghi lại 1 lần đọc bytes byte ở offset của vùng region
+static inline void dram_touch(int region, long long offset, int bytes) {
+    if (!dram.enabled) return;
+    long long addr = (long long)region * DRAM_REGION_BYTES + offset;
+    long long first = addr / DRAM_BURST_BYTES;
+    long long last = (addr + bytes - 1) / DRAM_BURST_BYTES;
+    dram.useful_bytes += bytes;
+    for (long long b = first; b <= last; b++) {
+        // Gộp ngay các lần đọc liên tiếp trong cùng burst (trường hợp phổ biến nhất)
+        if (dram.n > 0 && dram.bursts[dram.n - 1] == b) continue;
+        if (dram.n == dram.cap) {
+            dram.cap = dram.cap ? dram.cap * 2 : 256;
+            dram.bursts = (long long*)realloc(dram.bursts, dram.cap * sizeof(long long));
+        }
+        dram.bursts[dram.n++] = b;
+    }
+}
+
+static inline int dram_cmp_ll(const void* a, const void* b) {
+    long long x = *(const long long*)a, y = *(const long long*)b;
+    return (x > y) - (x < y);
+}
+
+// Kết thúc 1 giao dịch DMA: trả về số chu kỳ
+static inline unsigned long long dram_flush() {
+    if (dram.n == 0) return 0;
+    qsort(dram.bursts, dram.n, sizeof(long long), dram_cmp_ll);
+
+    unsigned long long transfer = (DRAM_BURST_BYTES + dram.bus_bytes - 1) / dram.bus_bytes;
+    unsigned long long cycles = DRAM_TCL;
+    long long prev = -1;
+    for (int i = 0; i < dram.n; i++) {
+        long long b = dram.bursts[i];
+        if (b == prev) continue;
+        prev = b;
+        long long row = b * DRAM_BURST_BYTES / DRAM_ROW_BYTES;
+        int bank = (int)(row % DRAM_NUM_BANKS);
+        if (dram.open_row[bank] == row) {
+            dram.row_hits++;
+        } else if (dram.open_row[bank] < 0) {
+            dram.row_empty++;
+            cycles += DRAM_TRCD;
+        } else {
+            dram.row_conflicts++;
+            cycles += DRAM_TRP + DRAM_TRCD;
+        }
+        dram.open_row[bank] = row;
+        cycles += transfer;
+        dram.burst_count++;
+    }
+    dram.n = 0;
+    dram.transactions++;
+    dram.cycles += cycles;
+    return cycles;
+}
+
+// Như dram_flush nhưng chỉ lấy các burst thuộc vùng region (các kênh DMA khác nhau gom riêng)
+static inline unsigned long long dram_flush_region(int region) {
+    if (dram.n == 0) return 0;
+    long long lo = (long long)region * DRAM_REGION_BYTES / DRAM_BURST_BYTES;
+    long long hi = lo + DRAM_REGION_BYTES / DRAM_BURST_BYTES;
+    // Dời burst của vùng khác ra sau, flush phần đầu rồi trả phần còn lại về
+    int k = 0;
+    for (int i = 0; i < dram.n; i++) {
+        if (dram.bursts[i] >= lo && dram.bursts[i] < hi) {
+            long long t = dram.bursts[k];
+            dram.bursts[k++] = dram.bursts[i];
+            dram.bursts[i] = t;
+        }
+    }
+    if (k == 0) return 0;
+    int rest = dram.n - k;
+    long long* others = 0;
+    if (rest > 0) {
+        others = (long long*)malloc(rest * sizeof(long long));
+        memcpy(others, dram.bursts + k, rest * sizeof(long long));
+    }
+    dram.n = k;
+    unsigned long long cycles = dram_flush();
+    if (rest > 0) {
+        memcpy(dram.bursts, others, rest * sizeof(long long));
+        dram.n = rest;
+        free(others);
+    }
+    return cycles;
+}
+
+// DRAM_STATS,giao dịch,burst,row hit,row empty,row conflict,byte có ích,byte trên bus,hiệu suất bus (%)
+static inline void dram_model_report() {
+    if (!dram.enabled) return;
+    unsigned long long bus_bytes = dram.burst_count * DRAM_BURST_BYTES;
+    double eff = bus_bytes ? 100.0 * (double)dram.useful_bytes / (double)bus_bytes : 0.0;
+    printf("DRAM_STATS,%llu,%llu,%llu,%llu,%llu,%llu,%llu,%.2f\n",
+           dram.transactions, dram.burst_count, dram.row_hits, dram.row_empty, dram.row_conflicts,
+           dram.useful_bytes, bus_bytes, eff);
+}
+
+static inline void dram_model_free() {
+    free(dram.bursts);
+    dram.bursts = 0;
+    dram.n = dram.cap = 0;
+}
+
+#endif // DRAM_MODEL_H
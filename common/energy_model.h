@@ -0,0 +1,62 @@
+// MÔ HÌNH NĂNG LƯỢNG THEO SỐ LẦN TRUY CẬP
+//
+// Năng lượng (pJ) = số byte DRAM * E_DRAM + số byte SRAM * E_SRAM + số lần truy cập thanh ghi * E_REG
+//                 + số phép MAC 8-bit * E_MAC
+//
+// Giá trị mặc định: công nghệ 45 nm (Horowitz, ISSCC 2014), có thể đổi bằng biến môi trường:
+//   - ENERGY_DRAM_PJ : pJ / byte DRAM (LPDDR, ~1.3 nJ / 64 bit)   (mặc định 160)
+//   - ENERGY_SRAM_PJ : pJ / byte SRAM (buffer 8 KB, 64 bit)       (mặc định 1.25)
+//   - ENERGY_GLB_PJ  : pJ / byte GLB (~100 KB, SIM_GLB=1)         (mặc định 2.5)
+//   - ENERGY_REG_PJ  : pJ / lần truy cập thanh ghi trong PE       (mặc định 0.23, ~1 MAC như Eyeriss)
+//   - ENERGY_MAC_PJ  : pJ / phép MAC 8-bit (nhân 0.2 + cộng 0.03)  (mặc định 0.23)
+//
+// Mỗi MAC tính 3 lần truy cập thanh ghi: 2 toán hạng + cập nhật psum.
+#ifndef ENERGY_MODEL_H
+#define ENERGY_MODEL_H
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define ENERGY_REG_PER_MAC 3
+
+typedef struct {
+    double dram_pj, sram_pj, glb_pj, reg_pj, mac_pj;    // pJ / đơn vị
+    unsigned long long dram_bytes, sram_bytes, glb_bytes, reg_accesses, macs;
+} energy_model;
+
+static energy_model energy;
+
+static inline double energy_env(const char* name, double def) {
+    const char* env = getenv(name);
+    return (env && atof(env) >= 0.0) ? atof(env) : def;
+}
+
+static inline void energy_model_init() {
+    energy.dram_pj = energy_env("ENERGY_DRAM_PJ", 160.0);
+    energy.sram_pj = energy_env("ENERGY_SRAM_PJ", 1.25);
+    energy.glb_pj = energy_env("ENERGY_GLB_PJ", 2.5);
+    energy.reg_pj = energy_env("ENERGY_REG_PJ", 0.23);
+    energy.mac_pj = energy_env("ENERGY_MAC_PJ", 0.23);
+    energy.dram_bytes = energy.sram_bytes = energy.glb_bytes = energy.reg_accesses = energy.macs = 0;
+}
+
+static inline void energy_dram(unsigned long long bytes) { energy.dram_bytes += bytes; }
+static inline void energy_sram(unsigned long long bytes) { energy.sram_bytes += bytes; }
+static inline void energy_glb(unsigned long long bytes) { energy.glb_bytes += bytes; }
+
+static inline void energy_mac(unsigned long long macs) {
+    energy.macs += macs;
+    energy.reg_accesses += macs * ENERGY_REG_PER_MAC;
+}
+
+static inline double energy_dram_total() { return energy.dram_bytes * energy.dram_pj; }
+static inline double energy_sram_total() { return energy.sram_bytes * energy.sram_pj; }
+static inline double energy_glb_total() { return energy.glb_bytes * energy.glb_pj; }
+static inline double energy_reg_total() { return energy.reg_accesses * energy.reg_pj; }
+static inline double energy_mac_total() { return energy.macs * energy.mac_pj; }
+
+static inline double energy_total() {
+    return energy_dram_total() + energy_sram_total() + energy_glb_total() + energy_reg_total() + energy_mac_total();
+}
+
+#endif // ENERGY_MODEL_H
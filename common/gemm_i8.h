@@ -0,0 +1,190 @@
+// GEMM INT8 x INT8 -> INT32 (CACHE-BLOCKED + REGISTER-TILED)
+//
+//   C[m*ldc + n] = sum_k A[m*lda + k] * Bt[n*ldb + k]      (0 <= m < M, 0 <= n < N)
+//
+// A  : ma trận im2col, mỗi hàng là 1 cửa sổ KH x KW x C của 1 pixel output
+// Bt : weight đã chuyển vị, mỗi hàng là 1 filter (K phần tử liên tiếp)
+// C  : OFM, layout [pixel][filter] -> trùng với [ho][wo][fo]
+//
+// Chia khối:
+//   - GEMM_KC: khối theo K để 4 hàng A + 2 hàng B nằm trong L1
+//   - Microkernel 4x2: 4 pixel x 2 filter = 8 accumulator nằm trong thanh ghi,
+//     mỗi lần load A được dùng lại cho 2 filter, mỗi lần load B dùng cho 4 pixel
+//   - Cột N lẻ (vd OUTPUT_F = 1) dùng kernel 4x1, các tile biên khác tính từng cặp
+//
+// Kết quả chính xác tuyệt đối (chỉ dùng phép nhân/cộng nguyên, không bão hòa).
+// Kernel AVX2 được chọn theo CPUID giống common/pe_simd.h, có fallback scalar.
+#ifndef GEMM_I8_H
+#define GEMM_I8_H
+
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define GEMM_I8_X86 1
+#endif
+
+#define GEMM_KC 512   // Kích thước khối theo K (byte)
+#define GEMM_MR 4     // Số pixel (hàng A) trong 1 tile thanh ghi
+#define GEMM_NR 2     // Số filter (hàng Bt) trong 1 tile thanh ghi
+
+// Kernel tổng quát: tile mr x nr (mr <= 4, nr <= 2), cộng dồn vào acc[mr][nr]
+typedef void (*gemm_tile_fn)(int mr, int nr, int kc,
+                             const int8_t* A, int lda, const int8_t* Bt, int ldb,
+                             int32_t acc[GEMM_MR][GEMM_NR]);
+
+// --- SCALAR ---
+static inline void gemm_tile_scalar(int mr, int nr, int kc,
+                                    const int8_t* A, int lda, const int8_t* Bt, int ldb,
+                                    int32_t acc[GEMM_MR][GEMM_NR]) {
+    for (int i = 0; i < mr; i++) {
+        for (int j = 0; j < nr; j++) {
+            const int8_t* a = A + i * lda;
+            const int8_t* b = Bt + j * ldb;
+            int32_t s = 0;
+            for (int k = 0; k < kc; k++) s += (int32_t)a[k] * (int32_t)b[k];
+            acc[i][j] += s;
+        }
+    }
+}
+
+#ifdef GEMM_I8_X86
+
+__attribute__((target("avx2")))
+static inline int32_t gemm_hsum_avx2(__m256i v) {
+    __m128i s = _mm_add_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(1, 0, 3, 2)));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(s);
+}
+
+// --- AVX2 ---
+// s8 -> s16 (vpmovsxbw) rồi vpmaddwd: 16 byte K mỗi bước, không bão hòa.
+__attribute__((target("avx2")))
+static inline void gemm_tile_avx2(int mr, int nr, int kc,
+                                  const int8_t* A, int lda, const int8_t* Bt, int ldb,
+                                  int32_t acc[GEMM_MR][GEMM_NR]) {
+    if (mr == GEMM_MR && nr == 1) {
+        // Kernel 4x1: 1 filter, B được dùng lại cho 4 pixel
+        __m256i c0 = _mm256_setzero_si256(), c1 = _mm256_setzero_si256();
+        __m256i c2 = _mm256_setzero_si256(), c3 = _mm256_setzero_si256();
+        int k = 0;
+        for (; k + 16 <= kc; k += 16) {
+            __m256i vb = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)(Bt + k)));
+            c0 = _mm256_add_epi32(c0, _mm256_madd_epi16(_mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)(A + k))), vb));
+            c1 = _mm256_add_epi32(c1, _mm256_madd_epi16(_mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)(A + lda + k))), vb));
+            c2 = _mm256_add_epi32(c2, _mm256_madd_epi16(_mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)(A + 2 * lda + k))), vb));
+            c3 = _mm256_add_epi32(c3, _mm256_madd_epi16(_mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)(A + 3 * lda + k))), vb));
+        }
+        acc[0][0] += gemm_hsum_avx2(c0); acc[1][0] += gemm_hsum_avx2(c1);
+        acc[2][0] += gemm_hsum_avx2(c2); acc[3][0] += gemm_hsum_avx2(c3);
+        for (; k < kc; k++) {
+            int32_t vb = Bt[k];
+            for (int i = 0; i < GEMM_MR; i++) acc[i][0] += A[i * lda + k] * vb;
+        }
+        return;
+    }
+    if (mr != GEMM_MR || nr != GEMM_NR) {
+        // Tile biên: tính từng hàng với vector, ít gặp nên không cần tối ưu thêm
+        for (int i = 0; i < mr; i++) {
+            for (int j = 0; j < nr; j++) {
+                const int8_t* a = A + i * lda;
+                const int8_t* b = Bt + j * ldb;
+                __m256i v = _mm256_setzero_si256();
+                int k = 0;
+                for (; k + 16 <= kc; k += 16) {
+                    __m256i va = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)(a + k)));
+                    __m256i vb = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)(b + k)));
+                    v = _mm256_add_epi32(v, _mm256_madd_epi16(va, vb));
+                }
+                int32_t s = gemm_hsum_avx2(v);
+                for (; k < kc; k++) s += (int32_t)a[k] * (int32_t)b[k];
+                acc[i][j] += s;
+            }
+        }
+        return;
+    }
+
+    __m256i c00 = _mm256_setzero_si256(), c01 = _mm256_setzero_si256();
+    __m256i c10 = _mm256_setzero_si256(), c11 = _mm256_setzero_si256();
+    __m256i c20 = _mm256_setzero_si256(), c21 = _mm256_setzero_si256();
+    __m256i c30 = _mm256_setzero_si256(), c31 = _mm256_setzero_si256();
+    const int8_t* a0 = A;
+    const int8_t* a1 = A + lda;
+    const int8_t* a2 = A + 2 * lda;
+    const int8_t* a3 = A + 3 * lda;
+    const int8_t* b0 = Bt;
+    const int8_t* b1 = Bt + ldb;
+
+    int k = 0;
+    for (; k + 16 <= kc; k += 16) {
+        __m256i vb0 = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)(b0 + k)));
+        __m256i vb1 = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)(b1 + k)));
+        __m256i va;
+        va = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)(a0 + k)));
+        c00 = _mm256_add_epi32(c00, _mm256_madd_epi16(va, vb0));
+        c01 = _mm256_add_epi32(c01, _mm256_madd_epi16(va, vb1));
+        va = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)(a1 + k)));
+        c10 = _mm256_add_epi32(c10, _mm256_madd_epi16(va, vb0));
+        c11 = _mm256_add_epi32(c11, _mm256_madd_epi16(va, vb1));
+        va = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)(a2 + k)));
+        c20 = _mm256_add_epi32(c20, _mm256_madd_epi16(va, vb0));
+        c21 = _mm256_add_epi32(c21, _mm256_madd_epi16(va, vb1));
+        va = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)(a3 + k)));
+        c30 = _mm256_add_epi32(c30, _mm256_madd_epi16(va, vb0));
+        c31 = _mm256_add_epi32(c31, _mm256_madd_epi16(va, vb1));
+    }
+    acc[0][0] += gemm_hsum_avx2(c00); acc[0][1] += gemm_hsum_avx2(c01);
+    acc[1][0] += gemm_hsum_avx2(c10); acc[1][1] += gemm_hsum_avx2(c11);
+    acc[2][0] += gemm_hsum_avx2(c20); acc[2][1] += gemm_hsum_avx2(c21);
+    acc[3][0] += gemm_hsum_avx2(c30); acc[3][1] += gemm_hsum_avx2(c31);
+
+    // Phần dư theo K
+    for (; k < kc; k++) {
+        int32_t vb0 = b0[k], vb1 = b1[k];
+        acc[0][0] += a0[k] * vb0; acc[0][1] += a0[k] * vb1;
+        acc[1][0] += a1[k] * vb0; acc[1][1] += a1[k] * vb1;
+        acc[2][0] += a2[k] * vb0; acc[2][1] += a2[k] * vb1;
+        acc[3][0] += a3[k] * vb0; acc[3][1] += a3[k] * vb1;
+    }
+}
+
+#endif // GEMM_I8_X86
+
+static inline gemm_tile_fn gemm_select_tile() {
+#ifdef GEMM_I8_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return gemm_tile_avx2;
+#endif
+    return gemm_tile_scalar;
+}
+
+// C = A * Bt^T (ghi đè C)
+static inline void gemm_i8_nt(int M, int N, int K,
+                              const int8_t* A, int lda,
+                              const int8_t* Bt, int ldb,
+                              int32_t* C, int ldc) {
+    static gemm_tile_fn tile = 0;
+    if (!tile) tile = gemm_select_tile();
+
+    for (int m = 0; m < M; m++) memset(C + (size_t)m * ldc, 0, N * sizeof(int32_t));
+
+    for (int k0 = 0; k0 < K; k0 += GEMM_KC) {
+        int kc = (K - k0 < GEMM_KC) ? (K - k0) : GEMM_KC;
+        for (int n0 = 0; n0 < N; n0 += GEMM_NR) {
+            int nr = (N - n0 < GEMM_NR) ? (N - n0) : GEMM_NR;
+            const int8_t* b = Bt + (size_t)n0 * ldb + k0;
+            for (int m0 = 0; m0 < M; m0 += GEMM_MR) {
+                int mr = (M - m0 < GEMM_MR) ? (M - m0) : GEMM_MR;
+                int32_t acc[GEMM_MR][GEMM_NR] = {{0}};
+                tile(mr, nr, kc, A + (size_t)m0 * lda + k0, lda, b, ldb, acc);
+                for (int i = 0; i < mr; i++)
+                    for (int j = 0; j < nr; j++)
+                        C[(size_t)(m0 + i) * ldc + n0 + j] += acc[i][j];
+            }
+        }
+    }
+}
+
+#endif // GEMM_I8_H
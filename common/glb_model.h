@@ -0,0 +1,132 @@
+// BỘ NHỚ PHÂN CẤP: DRAM -> GLB (GLOBAL BUFFER DÙNG CHUNG) -> SCRATCHPAD CỦA PE
+//
+// Mô hình cũ: DMA đọc thẳng từ DRAM vào buffer_ifm / buffer_weight, nên dữ liệu được load lại
+// (weight của Tiling ở mỗi pixel, phần chồng lấn cửa sổ IFM...) lần nào cũng tốn DRAM.
+//
+// Mô hình này (bật bằng SIM_GLB=1) chèn 1 GLB giữa DRAM và buffer on-chip:
+//   - DRAM      : bus DRAM_BUS_WIDTH_BYTES, ENERGY_DRAM_PJ
+//   - GLB       : GLB_BYTES dung lượng     (mặc định 110592 = 108 KB như Eyeriss)
+//                 GLB_BW byte / chu kỳ     (mặc định 16)
+//                 GLB_LINE byte / line     (mặc định 32 = 1 burst DRAM)
+//                 ENERGY_GLB_PJ pJ / byte  (common/energy_model.h)
+//   - Scratchpad: buffer_ifm / buffer_weight của dataflow (BUFFER_SIZE_BYTES, ENERGY_SRAM_PJ),
+//                 chia đều cho NUM_PE PE
+//   - Thanh ghi : trong PE (ENERGY_REG_PJ)
+//
+// Mỗi dataflow chọn giữ gì ở GLB bằng glb_keep(vùng, byte) theo thứ tự ưu tiên: vùng được giữ
+// nhận 1 phần GLB (direct-mapped theo line), vùng không được giữ đi thẳng DRAM -> scratchpad.
+// Đọc 1 byte của vùng được giữ: line có sẵn -> hit (chỉ đọc GLB); chưa có -> nạp cả line từ DRAM.
+// 1 giao dịch DMA tốn max(chu kỳ DRAM của byte nạp / đi thẳng, chu kỳ cổng GLB).
+#ifndef GLB_MODEL_H
+#define GLB_MODEL_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "dram_model.h"
+
+#define GLB_REGIONS 3           // DRAM_IFM, DRAM_WEIGHT, DRAM_OFM
+
+typedef struct {
+    long long* tag;             // tag[slot] = line đang nằm ở slot (-1 = trống)
+    int lines;                  // Số line của vùng trong GLB (0 = không giữ)
+    unsigned long long pend_read, pend_fill, pend_bypass;   // Byte của giao dịch đang gom
+    unsigned long long hits, misses;                        // Số lần đọc trúng / trượt line
+} glb_part;
+
+typedef struct {
+    int enabled;
+    int capacity, bw, line;
+    int free_bytes;
+    glb_part part[GLB_REGIONS];
+    unsigned long long read_bytes;      // Byte GLB -> scratchpad
+    unsigned long long fill_bytes;      // Byte DRAM -> GLB
+    unsigned long long bypass_bytes;    // Byte DRAM -> scratchpad (vùng không giữ)
+} glb_model;
+
+static glb_model glb;
+
+static inline int glb_env(const char* name, int def) {
+    const char* env = getenv(name);
+    return (env && atoi(env) > 0) ? atoi(env) : def;
+}
+
+static inline void glb_init() {
+    const char* env = getenv("SIM_GLB");
+    for (int r = 0; r < GLB_REGIONS; r++) free(glb.part[r].tag);
+    memset(&glb, 0, sizeof(glb));
+    glb.enabled = (env && atoi(env) != 0);
+    glb.capacity = glb_env("GLB_BYTES", 110592);
+    glb.bw = glb_env("GLB_BW", 16);
+    glb.line = glb_env("GLB_LINE", 32);
+    glb.free_bytes = glb.capacity;
+}
+
+// Dataflow giữ tối đa bytes byte của vùng region trong GLB (lấy từ phần GLB còn trống)
+static inline void glb_keep(int region, long long bytes) {
+    if (!glb.enabled || glb.part[region].lines) return;
+    if (bytes > glb.free_bytes) bytes = glb.free_bytes;
+    int lines = (int)(bytes / glb.line);
+    if (lines <= 0) return;
+    glb_part* p = &glb.part[region];
+    p->tag = (long long*)malloc(lines * sizeof(long long));
+    for (int i = 0; i < lines; i++) p->tag[i] = -1;
+    p->lines = lines;
+    glb.free_bytes -= lines * glb.line;
+}
+
+// Đọc bytes byte ở offset của vùng region trong 1 giao dịch DMA (thay cho dram_touch)
+static inline void glb_read(int region, long long offset, int bytes) {
+    if (!glb.enabled) {
+        dram_touch(region, offset, bytes);
+        return;
+    }
+    glb_part* p = &glb.part[region];
+    if (!p->lines) {
+        dram_touch(region, offset, bytes);
+        p->pend_bypass += bytes;
+        return;
+    }
+    for (long long l = offset / glb.line; l <= (offset + bytes - 1) / glb.line; l++) {
+        int slot = (int)(l % p->lines);
+        if (p->tag[slot] == l) {
+            p->hits++;
+            continue;
+        }
+        p->tag[slot] = l;
+        p->misses++;
+        dram_touch(region, l * glb.line, glb.line);
+        p->pend_fill += glb.line;
+    }
+    p->pend_read += bytes;
+}
+
+// Kết thúc giao dịch của vùng region: cộng byte đọc GLB / nạp GLB / đi thẳng vào read, fill, bypass
+static inline void glb_take(int region, unsigned long long* read, unsigned long long* fill,
+                            unsigned long long* bypass) {
+    glb_part* p = &glb.part[region];
+    *read += p->pend_read;
+    *fill += p->pend_fill;
+    *bypass += p->pend_bypass;
+    glb.read_bytes += p->pend_read;
+    glb.fill_bytes += p->pend_fill;
+    glb.bypass_bytes += p->pend_bypass;
+    p->pend_read = p->pend_fill = p->pend_bypass = 0;
+}
+
+// Chu kỳ cổng GLB: đọc ra scratchpad và nạp từ DRAM chạy song song (2 cổng)
+static inline unsigned long long glb_cycles(unsigned long long read, unsigned long long fill) {
+    unsigned long long r = (read + glb.bw - 1) / glb.bw;
+    unsigned long long w = (fill + glb.bw - 1) / glb.bw;
+    return (r > w) ? r : w;
+}
+
+static inline void glb_free() {
+    for (int r = 0; r < GLB_REGIONS; r++) {
+        free(glb.part[r].tag);
+        glb.part[r].tag = 0;
+        glb.part[r].lines = 0;
+    }
+}
+
+#endif // GLB_MODEL_H
@@ -0,0 +1,272 @@
+// FILE DUMP OP TFLITE (vd temp/op006_CONV_2D.txt)
+//
+// Script trích TFLite in mỗi op thành các mục:
+//   MODEL : <file .tflite>
+//   OP #6: CONV_2D
+//   === IFM === / === WEIGHTS === / === BIAS === / === OFM ===
+//     shape   : [1, 112, 112, 32]
+//     dtype   : <class 'numpy.int8'>
+//     quant   : {'scales': [...], 'zero_points': [...], 'axis': 0, ...}
+//     values(int): mảng numpy in lồng ngoặc [[[[ -48 -121 ... ]]]]
+//   === REQUANT (computed) ===   (M, n của 8 channel đầu: không đọc, tính lại được từ các scale)
+//   stride=(1, 1), padding=SAME, kernel=(3,3)   (trong phần VERIFY)
+// Trước đây phải tách tay ra params/*.txt. op_dump_load đọc cả file 1 lần (fread), đi từng dòng; vùng values
+// được xóa ngoặc tại chỗ rồi quét bằng tensor_parse_text (common/tensor_io.h) thẳng vào mảng của tensor.
+// Layout: IFM / OFM NHWC, WEIGHTS OHWI [F][KH][KW][C] (như weights.txt), BIAS [F] int32.
+// OFM trong dump là int8 đã requant (không so thẳng được với OFM int32 của mô phỏng).
+// Không có dòng stride / padding: stride 1, padding SAME nếu OH = ceil(H / stride), không thì VALID.
+#ifndef OP_DUMP_H
+#define OP_DUMP_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "tensor_io.h"
+
+#define OP_DUMP_IFM 0
+#define OP_DUMP_WEIGHTS 1
+#define OP_DUMP_BIAS 2
+#define OP_DUMP_OFM 3
+#define OP_DUMP_TENSORS 4
+
+static const char* op_dump_sections[OP_DUMP_TENSORS] = { "IFM", "WEIGHTS", "BIAS", "OFM" };
+
+typedef struct {
+    int present;
+    int index;                  // Chỉ số tensor trong model TFLite
+    int dtype;                  // TENSOR_I8 / TENSOR_I32
+    int ndim;
+    int dims[4];                // Chiều không dùng = 1
+    int nq;                     // Số scale / zero_point (1: cả tensor, F: từng channel theo quant_axis)
+    float* scales;
+    int32_t* zero_points;
+    int quant_axis;
+    void* data;                 // Giá trị (NULL nếu dump không có values)
+    long long count;            // Số giá trị đọc được
+} op_dump_tensor;
+
+typedef struct {
+    char model[128];
+    char op[32];
+    int op_index;
+    op_dump_tensor t[OP_DUMP_TENSORS];
+    int stride_h, stride_w;     // 0: dump không ghi
+    int same;                   // padding=SAME (1) / VALID (0), -1: dump không ghi
+    // Tham số lớp cho mô phỏng (op_dump_layer)
+    int in_h, in_w, in_c, k_h, k_w, out_f, out_h, out_w;
+    int pad_top, pad_left;      // Padding TF: SAME dồn phần lẻ xuống dưới / sang phải
+} op_dump;
+
+static inline long long op_dump_elems(const op_dump_tensor* t) {
+    long long n = 1;
+    for (int i = 0; i < t->ndim; i++) n *= t->dims[i];
+    return n;
+}
+
+// Số phần tử của list "[a, b, ...]" bắt đầu ở p (p trỏ vào '['), dừng ở ']' hoặc cuối dòng
+static inline int op_dump_list_len(const char* p) {
+    int n = 0, in_num = 0;
+    for (p++; *p && *p != ']' && *p != '\n'; p++) {
+        int sep = (*p == ',' || *p == ' ');
+        if (!sep && !in_num) n++;
+        in_num = !sep;
+    }
+    return n;
+}
+
+// Đọc list số (int hoặc float) "[a, b, ...]" ở p vào out (tối đa max phần tử). Trả về số phần tử
+static inline int op_dump_list(const char* p, double* out, int max) {
+    int n = 0;
+    if (*p != '[') return 0;
+    for (p++; *p && *p != ']' && *p != '\n' && n < max;) {
+        char* end;
+        double v = strtod(p, &end);
+        if (end == p) {
+            p++;            // ',' / ' '
+            continue;
+        }
+        out[n++] = v;
+        p = end;
+    }
+    return n;
+}
+
+// Sau key (vd 'scales') trong dòng: trỏ tới ký tự đầu của giá trị, NULL nếu không có
+static inline const char* op_dump_value(const char* line, const char* line_end, const char* key) {
+    size_t len = strlen(key);
+    for (const char* p = line; p + len <= line_end; p++) {
+        if (memcmp(p, key, len) != 0) continue;
+        p += len;
+        while (p < line_end && (*p == ':' || *p == ' ' || *p == '\'' || *p == '=')) p++;
+        return p;
+    }
+    return NULL;
+}
+
+// quant : {'scales': [...], 'zero_points': [...], 'axis': 0, ...}
+static inline void op_dump_quant(op_dump_tensor* t, const char* line, const char* line_end) {
+    const char* s = op_dump_value(line, line_end, "'scales'");
+    const char* z = op_dump_value(line, line_end, "'zero_points'");
+    const char* a = op_dump_value(line, line_end, "'axis'");
+    if (!s || !z || *s != '[' || *z != '[') return;
+    int n = op_dump_list_len(s);
+    if (n <= 0) return;
+    double* v = (double*)malloc(n * sizeof(double));
+    t->scales = (float*)calloc(n, sizeof(float));
+    t->zero_points = (int32_t*)calloc(n, sizeof(int32_t));
+    int ns = op_dump_list(s, v, n);
+    for (int i = 0; i < ns; i++) t->scales[i] = (float)v[i];
+    int nz = op_dump_list(z, v, n);
+    for (int i = 0; i < nz; i++) t->zero_points[i] = (int32_t)v[i];
+    free(v);
+    t->nq = n;
+    t->quant_axis = a ? atoi(a) : 0;
+}
+
+// Vùng values: các dòng sau "values(int):" bắt đầu bằng '[' hoặc ' ' (mảng numpy nhiều dòng, có dòng trống
+// giữa các khối). Xóa ngoặc tại chỗ rồi quét số. Trả về cuối vùng
+static inline char* op_dump_values(op_dump_tensor* t, char* p, char* end) {
+    char* start = p;
+    while (p < end && (*p == '[' || *p == ' ' || *p == '\n' || *p == '\r')) {
+        char* nl = (char*)memchr(p, '\n', end - p);
+        p = nl ? nl + 1 : end;
+    }
+    for (char* q = start; q < p; q++) {
+        if (*q == '[' || *q == ']') *q = ' ';
+    }
+    long long n = op_dump_elems(t);
+    if (t->ndim <= 0 || n <= 0) return p;
+    t->data = calloc((size_t)n, t->dtype);
+    if (t->data) t->count = tensor_parse_text(start, p - start, t->dtype, n, t->data);
+    return p;
+}
+
+// Tính tham số lớp từ shape (IFM [1, H, W, C], WEIGHTS [F, KH, KW, C], OFM [1, OH, OW, F]) + stride / padding.
+// Trả về 0 nếu thành công, -1 (đã in lỗi) nếu thiếu tensor hoặc không phải CONV_2D
+static inline int op_dump_layer(op_dump* d, const char* path) {
+    const op_dump_tensor* x = &d->t[OP_DUMP_IFM];
+    const op_dump_tensor* w = &d->t[OP_DUMP_WEIGHTS];
+    const op_dump_tensor* y = &d->t[OP_DUMP_OFM];
+    if (strcmp(d->op, "CONV_2D") != 0) {
+        printf("Error: %s is a %s op, only CONV_2D is simulated\n", path, d->op);
+        return -1;
+    }
+    if (!x->present || !w->present || !y->present || x->ndim < 3 || w->ndim != 4 || y->ndim < 3) {
+        printf("Error: %s has no IFM / WEIGHTS / OFM shape\n", path);
+        return -1;
+    }
+    const int* xd = x->dims + x->ndim - 3;      // Bỏ batch
+    const int* yd = y->dims + y->ndim - 3;
+    d->in_h = xd[0], d->in_w = xd[1], d->in_c = xd[2];
+    d->out_f = w->dims[0], d->k_h = w->dims[1], d->k_w = w->dims[2];
+    d->out_h = yd[0], d->out_w = yd[1];
+    if (w->dims[3] != d->in_c || yd[2] != d->out_f) {
+        printf("Error: %s: WEIGHTS [%d, %d, %d, %d] do not match IFM C=%d / OFM F=%d\n", path, w->dims[0],
+               w->dims[1], w->dims[2], w->dims[3], d->in_c, yd[2]);
+        return -1;
+    }
+    // Số giá trị đọc được phải đủ shape: dump bị cắt thì phần thiếu sẽ thành 0 mà không ai biết.
+    // IFM / WEIGHTS thiếu -> từ chối (mô phỏng sai), BIAS / OFM thiếu -> chỉ cảnh báo
+    for (int i = 0; i < OP_DUMP_TENSORS; i++) {
+        const op_dump_tensor* t = &d->t[i];
+        if (!t->data || t->count == op_dump_elems(t)) continue;
+        int needed = (i == OP_DUMP_IFM || i == OP_DUMP_WEIGHTS);
+        printf("%s: %s: %s has %lld values, shape needs %lld\n", needed ? "Error" : "Warning", path,
+               op_dump_sections[i], t->count, op_dump_elems(t));
+        if (needed) return -1;
+    }
+    if (d->stride_h <= 0) d->stride_h = 1;
+    if (d->stride_w <= 0) d->stride_w = d->stride_h;
+    if (d->same < 0) d->same = (d->out_h == (d->in_h + d->stride_h - 1) / d->stride_h);
+    d->pad_top = d->pad_left = 0;
+    if (d->same) {
+        int pad_h = (d->out_h - 1) * d->stride_h + d->k_h - d->in_h;
+        int pad_w = (d->out_w - 1) * d->stride_w + d->k_w - d->in_w;
+        d->pad_top = (pad_h > 0) ? pad_h / 2 : 0;
+        d->pad_left = (pad_w > 0) ? pad_w / 2 : 0;
+    }
+    return 0;
+}
+
+// Đọc file dump. Trả về 0 nếu thành công, -1 nếu không mở được file
+static inline int op_dump_load(const char* path, op_dump* d) {
+    memset(d, 0, sizeof(*d));
+    d->same = -1;
+    FILE* f = fopen(path, "rb");
+    if (!f) return -1;
+    long long size = -1;
+    if (fseek(f, 0, SEEK_END) == 0) size = ftell(f);
+    char* buf = (size >= 0) ? (char*)malloc((size_t)size + 64 + 8) : NULL;
+    if (!buf || fseek(f, 0, SEEK_SET) != 0 || fread(buf, 1, (size_t)size, f) != (size_t)size) {
+        free(buf);
+        fclose(f);
+        return -1;
+    }
+    fclose(f);
+    memset(buf + size, 0, 64 + 8);
+
+    op_dump_tensor* t = NULL;   // Mục đang đọc
+    char* end = buf + size;
+    for (char* p = buf; p < end;) {
+        char* nl = (char*)memchr(p, '\n', end - p);
+        char* line_end = nl ? nl : end;
+        char* next = nl ? nl + 1 : end;
+        const char* v;
+        if (strncmp(p, "=== ", 4) == 0) {
+            t = NULL;
+            for (int i = 0; i < OP_DUMP_TENSORS; i++) {
+                size_t len = strlen(op_dump_sections[i]);
+                if (strncmp(p + 4, op_dump_sections[i], len) == 0 && p[4 + len] == ' ') t = &d->t[i];
+            }
+            if (t) t->present = 1;
+        } else if (strncmp(p, "MODEL", 5) == 0 && (v = op_dump_value(p, line_end, "MODEL"))) {
+            int len = (int)(line_end - v);
+            snprintf(d->model, sizeof(d->model), "%.*s", len, v);
+        } else if (strncmp(p, "OP #", 4) == 0) {
+            d->op_index = atoi(p + 4);
+            v = (const char*)memchr(p, ':', line_end - p);
+            if (v) {
+                for (v++; *v == ' '; v++) {}
+                snprintf(d->op, sizeof(d->op), "%.*s", (int)(line_end - v), v);
+            }
+        } else if (t && strncmp(p, "shape", 5) == 0 && (v = op_dump_value(p, line_end, "shape")) && *v == '[') {
+            double dims[8];
+            int n = op_dump_list(v, dims, 8);
+            // Hơn 4 chiều: bỏ các chiều 1 ở đầu
+            int skip = 0;
+            while (n - skip > 4 && dims[skip] == 1) skip++;
+            t->ndim = (n - skip <= 4) ? n - skip : 0;
+            for (int i = 0; i < 4; i++) t->dims[i] = (i < t->ndim) ? (int)dims[skip + i] : 1;
+        } else if (t && strncmp(p, "index", 5) == 0 && (v = op_dump_value(p, line_end, "index"))) {
+            t->index = atoi(v);
+        } else if (t && strncmp(p, "dtype", 5) == 0) {
+            t->dtype = (op_dump_value(p, line_end, "int32") || op_dump_value(p, line_end, "int64")) ? TENSOR_I32
+                                                                                                   : TENSOR_I8;
+        } else if (t && strncmp(p, "quant", 5) == 0) {
+            op_dump_quant(t, p, line_end);
+        } else if (t && strncmp(p, "values", 6) == 0) {
+            if (!t->dtype) t->dtype = TENSOR_I8;
+            next = op_dump_values(t, next, end);
+        } else if ((v = op_dump_value(p, line_end, "stride=(")) && !d->stride_h) {
+            d->stride_h = atoi(v);
+            v = (const char*)memchr(v, ',', line_end - v);
+            d->stride_w = v ? atoi(v + 1) : d->stride_h;
+            if ((v = op_dump_value(p, line_end, "padding"))) d->same = (strncmp(v, "SAME", 4) == 0);
+        }
+        p = next;
+    }
+    free(buf);
+    return 0;
+}
+
+static inline void op_dump_free(op_dump* d) {
+    for (int i = 0; i < OP_DUMP_TENSORS; i++) {
+        free(d->t[i].scales);
+        free(d->t[i].zero_points);
+        free(d->t[i].data);
+    }
+    memset(d, 0, sizeof(*d));
+}
+
+#endif // OP_DUMP_H
@@ -0,0 +1,171 @@
+// KERNEL TÍCH VÔ HƯỚNG INT8 CHO MẢNG PE (SIMD + CHỌN THEO CPUID)
+//
+// Mảng PE tính: sum_{pe, k} buffer_ifm[pe*MACS_PER_PE + k] * buffer_weight[pe*MACS_PER_PE + k]
+// Phép cộng số nguyên có tính kết hợp nên gom cả mảng thành 1 tích vô hướng
+// dài NUM_PE * MACS_PER_PE phần tử cho kết quả GIỐNG HỆT vòng lặp scalar cũ.
+//
+// Các phiên bản:
+//   - AVX-512 VNNI : vpdpbusd (u8 x s8 -> s32, không bão hòa), 64 byte/lệnh
+//   - AVX2         : sign-extend s8 -> s16 rồi vpmaddwd, 32 byte/vòng
+//   - SSE4.1       : pmovsxbw + pmaddwd, 16 byte/vòng
+//   - Scalar       : vòng lặp gốc (fallback cho CPU khác / không phải x86)
+//
+// Lưu ý: KHÔNG dùng maddubs (pmaddubsw) vì tổng 2 tích int8 x int8 có thể
+// vượt int16 (vd: 128*128*2) và bị bão hòa -> sai lệch với kết quả scalar.
+//
+// Kernel được chọn MỘT LẦN ở lần gọi đầu tiên (CPUID). Có thể ép bằng biến
+// môi trường PE_SIMD=scalar|sse4|avx2|vnni để so sánh / kiểm tra.
+#ifndef PE_SIMD_H
+#define PE_SIMD_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define PE_SIMD_X86 1
+#endif
+
+typedef int32_t (*pe_dot_fn)(const int8_t* a, const int8_t* b, int n);
+
+// --- SCALAR (Tham chiếu) ---
+static inline int32_t pe_dot_scalar(const int8_t* a, const int8_t* b, int n) {
+    int32_t acc = 0;
+    for (int i = 0; i < n; i++) {
+        acc += (int32_t)a[i] * (int32_t)b[i];
+    }
+    return acc;
+}
+
+#ifdef PE_SIMD_X86
+
+// --- SSE4.1 ---
+__attribute__((target("sse4.1")))
+static inline int32_t pe_dot_sse4(const int8_t* a, const int8_t* b, int n) {
+    __m128i acc = _mm_setzero_si128();
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i va = _mm_loadu_si128((const __m128i*)(a + i));
+        __m128i vb = _mm_loadu_si128((const __m128i*)(b + i));
+        // 8 byte thấp
+        __m128i a_lo = _mm_cvtepi8_epi16(va);
+        __m128i b_lo = _mm_cvtepi8_epi16(vb);
+        // 8 byte cao
+        __m128i a_hi = _mm_cvtepi8_epi16(_mm_srli_si128(va, 8));
+        __m128i b_hi = _mm_cvtepi8_epi16(_mm_srli_si128(vb, 8));
+        acc = _mm_add_epi32(acc, _mm_madd_epi16(a_lo, b_lo));
+        acc = _mm_add_epi32(acc, _mm_madd_epi16(a_hi, b_hi));
+    }
+    // Cộng ngang 4 lane
+    acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(1, 0, 3, 2)));
+    acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(2, 3, 0, 1)));
+    int32_t sum = _mm_cvtsi128_si32(acc);
+    // Phần dư
+    for (; i < n; i++) sum += (int32_t)a[i] * (int32_t)b[i];
+    return sum;
+}
+
+// --- AVX2 ---
+__attribute__((target("avx2")))
+static inline int32_t pe_dot_avx2(const int8_t* a, const int8_t* b, int n) {
+    __m256i acc0 = _mm256_setzero_si256();
+    __m256i acc1 = _mm256_setzero_si256();
+    int i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m128i a0 = _mm_loadu_si128((const __m128i*)(a + i));
+        __m128i a1 = _mm_loadu_si128((const __m128i*)(a + i + 16));
+        __m128i b0 = _mm_loadu_si128((const __m128i*)(b + i));
+        __m128i b1 = _mm_loadu_si128((const __m128i*)(b + i + 16));
+        acc0 = _mm256_add_epi32(acc0, _mm256_madd_epi16(_mm256_cvtepi8_epi16(a0), _mm256_cvtepi8_epi16(b0)));
+        acc1 = _mm256_add_epi32(acc1, _mm256_madd_epi16(_mm256_cvtepi8_epi16(a1), _mm256_cvtepi8_epi16(b1)));
+    }
+    if (i + 16 <= n) {
+        __m128i a0 = _mm_loadu_si128((const __m128i*)(a + i));
+        __m128i b0 = _mm_loadu_si128((const __m128i*)(b + i));
+        acc0 = _mm256_add_epi32(acc0, _mm256_madd_epi16(_mm256_cvtepi8_epi16(a0), _mm256_cvtepi8_epi16(b0)));
+        i += 16;
+    }
+    __m256i acc = _mm256_add_epi32(acc0, acc1);
+    __m128i s = _mm_add_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(1, 0, 3, 2)));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(2, 3, 0, 1)));
+    int32_t sum = _mm_cvtsi128_si32(s);
+    for (; i < n; i++) sum += (int32_t)a[i] * (int32_t)b[i];
+    return sum;
+}
+
+// --- AVX-512 VNNI ---
+// vpdpbusd nhân u8 x s8. Đổi a (s8) sang u8 bằng cách cộng 128 (xor 0x80):
+//   sum(a*b) = sum((a+128)*b) - 128*sum(b)
+// sum(b) cũng tính bằng vpdpbusd với vector toàn số 1. Không có bão hòa -> chính xác.
+__attribute__((target("avx512f,avx512bw,avx512vnni")))
+static inline int32_t pe_dot_vnni(const int8_t* a, const int8_t* b, int n) {
+    const __m512i bias = _mm512_set1_epi8((char)0x80);
+    const __m512i ones = _mm512_set1_epi8(1);
+    __m512i acc = _mm512_setzero_si512();
+    __m512i bsum = _mm512_setzero_si512();
+    int i = 0;
+    for (; i + 64 <= n; i += 64) {
+        __m512i va = _mm512_loadu_si512((const void*)(a + i));
+        __m512i vb = _mm512_loadu_si512((const void*)(b + i));
+        acc = _mm512_dpbusd_epi32(acc, _mm512_xor_si512(va, bias), vb);
+        bsum = _mm512_dpbusd_epi32(bsum, ones, vb);
+    }
+    // Phần dư < 64 byte: load có mask (byte ngoài mask = 0 -> không ảnh hưởng tổng)
+    if (i < n) {
+        __mmask64 m = (~0ULL) >> (64 - (n - i));
+        __m512i va = _mm512_maskz_loadu_epi8(m, a + i);
+        __m512i vb = _mm512_maskz_loadu_epi8(m, b + i);
+        acc = _mm512_dpbusd_epi32(acc, _mm512_xor_si512(va, bias), vb);
+        bsum = _mm512_dpbusd_epi32(bsum, ones, vb);
+    }
+    // Cộng ngang 16 lane của 2 accumulator
+    int32_t lanes_acc[16], lanes_b[16];
+    _mm512_storeu_si512((void*)lanes_acc, acc);
+    _mm512_storeu_si512((void*)lanes_b, bsum);
+    int32_t sum = 0;
+    for (int l = 0; l < 16; l++) sum += lanes_acc[l] - 128 * lanes_b[l];
+    return sum;
+}
+
+#endif // PE_SIMD_X86
+
+// --- DISPATCH ---
+static inline int32_t pe_dot_resolve(const int8_t* a, const int8_t* b, int n);
+
+// Con trỏ hàm dùng chung; lần gọi đầu tiên sẽ tự chọn kernel phù hợp
+static pe_dot_fn pe_dot_i8 = pe_dot_resolve;
+__attribute__((unused)) static const char* pe_dot_name = "unresolved";
+
+static inline void pe_simd_init() {
+    const char* force = getenv("PE_SIMD");
+    pe_dot_i8 = pe_dot_scalar;
+    pe_dot_name = "scalar";
+#ifdef PE_SIMD_X86
+    __builtin_cpu_init();
+    int has_vnni = __builtin_cpu_supports("avx512vnni") && __builtin_cpu_supports("avx512bw");
+    int has_avx2 = __builtin_cpu_supports("avx2");
+    int has_sse4 = __builtin_cpu_supports("sse4.1");
+
+    if (force) {
+        if (strcmp(force, "vnni") == 0 && has_vnni)      { pe_dot_i8 = pe_dot_vnni; pe_dot_name = "vnni"; }
+        else if (strcmp(force, "avx2") == 0 && has_avx2) { pe_dot_i8 = pe_dot_avx2; pe_dot_name = "avx2"; }
+        else if (strcmp(force, "sse4") == 0 && has_sse4) { pe_dot_i8 = pe_dot_sse4; pe_dot_name = "sse4"; }
+        return;
+    }
+    if (has_vnni)      { pe_dot_i8 = pe_dot_vnni; pe_dot_name = "vnni"; }
+    else if (has_avx2) { pe_dot_i8 = pe_dot_avx2; pe_dot_name = "avx2"; }
+    else if (has_sse4) { pe_dot_i8 = pe_dot_sse4; pe_dot_name = "sse4"; }
+#else
+    (void)force;
+#endif
+}
+
+static inline int32_t pe_dot_resolve(const int8_t* a, const int8_t* b, int n) {
+    pe_simd_init();
+    return pe_dot_i8(a, b, n);
+}
+
+#endif // PE_SIMD_H
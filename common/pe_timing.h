@@ -0,0 +1,95 @@
+// MÔ HÌNH THỜI GIAN CỦA MẢNG PE (SIM_PE_MODEL)
+//
+// run_pe_array cộng tích của mọi PE thành 1 partial_sum. Mô hình cũ coi việc này xong trong
+// PE_COMPUTE_CYCLES chu kỳ, bất kể NUM_PE. Có 3 mô hình để chọn:
+//   - ideal (0, mặc định)   : 1 lượt = PE_COMPUTE_CYCLES chu kỳ, không có độ trễ (như cũ)
+//   - tree (1)              : cây cộng pipeline, ceil(log2(NUM_PE * MACS_PER_PE)) tầng cộng,
+//                             TREE_STAGE_LEVELS tầng / 1 stage pipeline (mặc định 1)
+//                             -> fill = số stage - 1, drain = 0
+//   - systolic (2)          : lưới SYSTOLIC_ROWS x SYSTOLIC_COLS PE (mặc định gần vuông, đủ NUM_PE)
+//                             -> fill = ROWS - 1 (dữ liệu vào lệch nhau), drain = COLS - 1 (psum đi ra)
+// Trong 1 pass các lượt nối đuôi nhau qua pipeline (mỗi lượt vẫn PE_COMPUTE_CYCLES chu kỳ),
+// mỗi lần sang pass mới pipeline phải fill + drain lại 1 lần.
+// Chỉ áp dụng cho dataflow cộng dồn qua các PE (Tiling, IS, WS, WS+IS, Winograd); OS cộng trong từng PE,
+// RS đã tính KERNEL_H-1 chu kỳ psum chảy dọc cột.
+#ifndef PE_TIMING_H
+#define PE_TIMING_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PE_MODEL_IDEAL 0
+#define PE_MODEL_TREE 1
+#define PE_MODEL_SYSTOLIC 2
+
+typedef struct {
+    int model;
+    int levels, stage_levels, stages;   // Cây cộng
+    int rows, cols;                     // Lưới systolic
+    int fill, drain;                    // Chu kỳ fill / drain mỗi pass
+    int last_pass;                      // Pass của lượt trước (-1: chưa có)
+    unsigned long long ramps;           // Số lần fill + drain
+    unsigned long long ramp_cycles;     // Tổng chu kỳ fill + drain
+} pe_timing_model;
+
+static pe_timing_model pe_timing;
+
+static inline int pe_timing_env(const char* name, int def) {
+    const char* env = getenv(name);
+    return (env && atoi(env) > 0) ? atoi(env) : def;
+}
+
+static inline void pe_timing_init(int num_pe, int macs_per_pe) {
+    memset(&pe_timing, 0, sizeof(pe_timing));
+    pe_timing.last_pass = -1;
+    const char* env = getenv("SIM_PE_MODEL");
+    if (env && (strcmp(env, "tree") == 0 || atoi(env) == PE_MODEL_TREE)) pe_timing.model = PE_MODEL_TREE;
+    if (env && (strcmp(env, "systolic") == 0 || atoi(env) == PE_MODEL_SYSTOLIC)) pe_timing.model = PE_MODEL_SYSTOLIC;
+
+    // Cây cộng: số tầng = ceil(log2(số tích cộng lại))
+    long long n = (long long)num_pe * macs_per_pe;
+    while ((1LL << pe_timing.levels) < n) pe_timing.levels++;
+    pe_timing.stage_levels = pe_timing_env("TREE_STAGE_LEVELS", 1);
+    pe_timing.stages = (pe_timing.levels + pe_timing.stage_levels - 1) / pe_timing.stage_levels;
+    if (pe_timing.stages < 1) pe_timing.stages = 1;
+
+    // Lưới systolic: mặc định ROWS = ước lớn nhất của NUM_PE không quá sqrt(NUM_PE)
+    int rows = 1;
+    for (int r = 1; r * r <= num_pe; r++) {
+        if (num_pe % r == 0) rows = r;
+    }
+    pe_timing.rows = pe_timing_env("SYSTOLIC_ROWS", rows);
+    pe_timing.cols = pe_timing_env("SYSTOLIC_COLS", (num_pe + pe_timing.rows - 1) / pe_timing.rows);
+
+    if (pe_timing.model == PE_MODEL_TREE) {
+        pe_timing.fill = pe_timing.stages - 1;
+    } else if (pe_timing.model == PE_MODEL_SYSTOLIC) {
+        pe_timing.fill = pe_timing.rows - 1;
+        pe_timing.drain = pe_timing.cols - 1;
+    }
+}
+
+// Chu kỳ thêm vào lượt tính của pass pass_idx: fill + drain khi lượt này mở đầu 1 pass mới
+static inline unsigned long long pe_timing_ramp(int pass_idx) {
+    if (pass_idx == pe_timing.last_pass) return 0;
+    pe_timing.last_pass = pass_idx;
+    unsigned long long ramp = (unsigned long long)pe_timing.fill + pe_timing.drain;
+    if (ramp) {
+        pe_timing.ramps++;
+        pe_timing.ramp_cycles += ramp;
+    }
+    return ramp;
+}
+
+// PE_TIMING_STATS,mô hình,fill,drain,số lần fill+drain,chu kỳ fill+drain,MAC/chu kỳ ổn định,MAC/chu kỳ kể cả fill+drain
+//   compute_cycles: chu kỳ compute (đã gồm fill + drain), macs: số MAC thật
+static inline void pe_timing_report(unsigned long long compute_cycles, unsigned long long macs) {
+    static const char* names[] = { "ideal", "tree", "systolic" };
+    unsigned long long steady = compute_cycles - pe_timing.ramp_cycles;
+    printf("PE_TIMING_STATS,%s,%d,%d,%llu,%llu,%.3f,%.3f\n", names[pe_timing.model], pe_timing.fill,
+           pe_timing.drain, pe_timing.ramps, pe_timing.ramp_cycles,
+           steady ? (double)macs / steady : 0.0, compute_cycles ? (double)macs / compute_cycles : 0.0);
+}
+
+#endif // PE_TIMING_H
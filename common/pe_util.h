@@ -0,0 +1,136 @@
+// HIỆU SUẤT SỬ DỤNG MẢNG PE (UTILIZATION)
+//
+// Mỗi chu kỳ compute, mảng PE có NUM_PE * MACS_PER_PE MAC-slot, nhưng không phải slot nào cũng làm việc:
+//   - Pass cuối khi INPUT_C không chia hết cho PARALLEL_CHANNELS: chỉ num_c channel có dữ liệu
+//   - NUM_PE * MACS_PER_PE không chia hết cho số MAC của 1 channel (vd KERNEL_H * KERNEL_W): MAC thừa
+//   - Khối pixel / nhóm hàng cuối nhỏ hơn số PE (OS, RS)
+// Mô hình đếm MAC thật (active) và MAC-slot có sẵn:
+//   - pe_util_slots(pass, chu kỳ)   : 1 lượt tính chiếm cả mảng PE trong "chu kỳ" chu kỳ MAC
+//   - pe_util_pe(pass, pe, n, macs) : n PE liên tiếp từ pe, mỗi PE làm macs MAC trong lượt đó
+//   - pe_util_fill(pass, m, chu kỳ) : mỗi chu kỳ m MAC xếp liên tiếp từ PE 0 (tích vô hướng trải phẳng)
+// Utilization không gian = MAC thật / slot của các chu kỳ MAC (theo từng pass và cả lớp).
+// Utilization tổng (trong sim_report) chia cho slot của mọi chu kỳ compute, kể cả biến đổi Winograd
+// và stall bank SRAM.
+#ifndef PE_UTIL_H
+#define PE_UTIL_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    int num_pe, macs_per_pe;
+    unsigned long long active_macs;     // MAC thật
+    unsigned long long mac_cycles;      // Chu kỳ MAC (slot = num_pe * macs_per_pe * mac_cycles)
+    unsigned long long steps;           // Số lượt tính
+    unsigned long long* pe_macs;        // pe_macs[pe]: MAC thật của từng PE
+    int num_passes;
+    unsigned long long* pass_macs;      // pass_macs[p]: MAC thật của pass p
+    unsigned long long* pass_cycles;    // pass_cycles[p]: chu kỳ MAC của pass p
+} pe_util_model;
+
+static pe_util_model pe_util;
+
+static inline void pe_util_init(int num_pe, int macs_per_pe) {
+    free(pe_util.pe_macs);
+    free(pe_util.pass_macs);
+    free(pe_util.pass_cycles);
+    memset(&pe_util, 0, sizeof(pe_util));
+    pe_util.num_pe = num_pe;
+    pe_util.macs_per_pe = macs_per_pe;
+    pe_util.pe_macs = (unsigned long long*)calloc(num_pe, sizeof(unsigned long long));
+}
+
+static inline unsigned long long pe_util_capacity() {
+    return (unsigned long long)pe_util.num_pe * pe_util.macs_per_pe;
+}
+
+// Mở rộng bảng theo pass khi gặp pass mới
+static inline void pe_util_pass(int pass) {
+    if (pass < pe_util.num_passes) return;
+    int n = pass + 1;
+    pe_util.pass_macs = (unsigned long long*)realloc(pe_util.pass_macs, n * sizeof(unsigned long long));
+    pe_util.pass_cycles = (unsigned long long*)realloc(pe_util.pass_cycles, n * sizeof(unsigned long long));
+    for (int p = pe_util.num_passes; p < n; p++) pe_util.pass_macs[p] = pe_util.pass_cycles[p] = 0;
+    pe_util.num_passes = n;
+}
+
+static inline void pe_util_slots(int pass, unsigned long long cycles) {
+    pe_util_pass(pass);
+    pe_util.mac_cycles += cycles;
+    pe_util.pass_cycles[pass] += cycles;
+    pe_util.steps++;
+}
+
+static inline void pe_util_pe(int pass, int pe, int count, unsigned long long macs) {
+    pe_util_pass(pass);
+    for (int i = pe; i < pe + count && i < pe_util.num_pe; i++) pe_util.pe_macs[i] += macs;
+    pe_util.active_macs += (unsigned long long)count * macs;
+    pe_util.pass_macs[pass] += (unsigned long long)count * macs;
+}
+
+static inline void pe_util_fill(int pass, long long macs_per_cycle, unsigned long long cycles) {
+    pe_util_slots(pass, cycles);
+    int mpp = pe_util.macs_per_pe;
+    int full = (int)(macs_per_cycle / mpp);
+    pe_util_pe(pass, 0, full, (unsigned long long)mpp * cycles);
+    if (macs_per_cycle % mpp) pe_util_pe(pass, full, 1, (unsigned long long)(macs_per_cycle % mpp) * cycles);
+}
+
+static inline double pe_util_ratio(unsigned long long macs, unsigned long long cycles) {
+    unsigned long long slots = pe_util_capacity() * cycles;
+    return slots ? (double)macs / slots : 0.0;
+}
+
+// UTIL_STATS,MAC thật,MAC-slot (theo chu kỳ compute),utilization tổng,utilization không gian,
+//            utilization pass thấp nhất,số PE không làm MAC nào
+// SIM_UTIL=1: thêm UTIL_PASS,pass,MAC thật,chu kỳ MAC,utilization không gian (1 dòng / pass)
+// SIM_PE_CSV=<file>: ghi bản đồ hoạt động từng PE (pe,active_macs,mac_slots,utilization)
+static inline void pe_util_report(unsigned long long compute_cycles) {
+    double worst = 1.0;
+    for (int p = 0; p < pe_util.num_passes; p++) {
+        double u = pe_util_ratio(pe_util.pass_macs[p], pe_util.pass_cycles[p]);
+        if (pe_util.pass_cycles[p] && u < worst) worst = u;
+    }
+    int idle = 0;
+    for (int i = 0; i < pe_util.num_pe; i++) {
+        if (!pe_util.pe_macs[i]) idle++;
+    }
+    printf("UTIL_STATS,%llu,%llu,%.4f,%.4f,%.4f,%d\n", pe_util.active_macs, pe_util_capacity() * compute_cycles,
+           pe_util_ratio(pe_util.active_macs, compute_cycles),
+           pe_util_ratio(pe_util.active_macs, pe_util.mac_cycles), worst, idle);
+
+    const char* env = getenv("SIM_UTIL");
+    if (env && atoi(env) != 0) {
+        for (int p = 0; p < pe_util.num_passes; p++) {
+            printf("UTIL_PASS,%d,%llu,%llu,%.4f\n", p, pe_util.pass_macs[p], pe_util.pass_cycles[p],
+                   pe_util_ratio(pe_util.pass_macs[p], pe_util.pass_cycles[p]));
+        }
+    }
+
+    const char* path = getenv("SIM_PE_CSV");
+    if (path && path[0]) {
+        FILE* f = fopen(path, "w");
+        if (!f) {
+            printf("Error: cannot write %s\n", path);
+            return;
+        }
+        unsigned long long slots = (unsigned long long)pe_util.macs_per_pe * pe_util.mac_cycles;
+        fprintf(f, "pe,active_macs,mac_slots,utilization\n");
+        for (int i = 0; i < pe_util.num_pe; i++) {
+            fprintf(f, "%d,%llu,%llu,%.4f\n", i, pe_util.pe_macs[i], slots,
+                    slots ? (double)pe_util.pe_macs[i] / slots : 0.0);
+        }
+        fclose(f);
+    }
+}
+
+static inline void pe_util_free() {
+    free(pe_util.pe_macs);
+    free(pe_util.pass_macs);
+    free(pe_util.pass_cycles);
+    pe_util.pe_macs = pe_util.pass_macs = pe_util.pass_cycles = 0;
+    pe_util.num_passes = 0;
+}
+
+#endif // PE_UTIL_H
@@ -0,0 +1,732 @@
+// PHẦN DÙNG CHUNG CỦA CÁC MÔ PHỎNG DATAFLOW (config/config_conv2d_*.cpp)
+//
+// Đọc tham số (13 tham số dòng lệnh hoặc file dump op), nạp DRAM mô phỏng (ifm_dram [h][w][c],
+// weight_dram [kh][kw][c][f], ofm_dram [ho][wo][fo]), chọn tile, dựng các unit / buffer của lõi thời gian
+// (common/sim_timing.h), tính chu kỳ DMA / compute / psum qua các mô hình trong common/ và in kết quả
+// (SURVEY_RESULT + các dòng *_STATS). Chế độ tùy chọn bật bằng biến môi trường SIM_* (xem readme.md).
+//
+// Mỗi dataflow chỉ còn phải viết: hàm DMA (nạp buffer rồi gọi sim_dma_load), mảng PE và controller.
+#ifndef SIM_CORE_H
+#define SIM_CORE_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include "pe_simd.h"
+#include "sim_timing.h"
+#include "dram_model.h"
+#include "sram_model.h"
+#include "energy_model.h"
+#include "glb_model.h"
+#include "dma_desc.h"
+#include "tiling_planner.h"
+#include "pe_util.h"
+#include "pe_timing.h"
+#include "tensor_io.h"
+#include "op_dump.h"
+
+// --- CẤU HÌNH BÀI TOÁN ---
+int INPUT_H, INPUT_W, INPUT_C;
+int KERNEL_H, KERNEL_W;
+int OUTPUT_F, OUTPUT_H, OUTPUT_W;
+int STRIDE, PADDING;
+
+// --- CẤU HÌNH PHẦN CỨNG ---
+int NUM_PE, MACS_PER_PE, BUFFER_SIZE_BYTES;
+int PARALLEL_CHANNELS;
+tile_plan sim_plan;     // Tile do sim_plan_tiling chọn (PARALLEL_CHANNELS = sim_plan.tc)
+
+// --- CẤU HÌNH HIỆU NĂNG ---
+// Đọc lúc chạy từ biến môi trường (sim_parse_args) để 1 binary quét được cả không gian thiết kế:
+//   SIM_BUS_BYTES, SIM_PE_CYCLES, SIM_FREQ_MHZ, SIM_DMA_SETUP (chu kỳ), SIM_DRAM_NS (ns)
+int DRAM_BUS_WIDTH_BYTES = 8;   // Bus 64-bit (8 bytes/cycle)
+int PE_COMPUTE_CYCLES = 1;      // Số cycle để PE array hoàn thành 1 lượt tính
+double SYSTEM_FREQ_MHZ = 100.0; // Tần số accelerator
+int DMA_SETUP_CYCLES = 0;       // Chu kỳ khởi tạo mỗi descriptor DMA (common/dma_desc.h)
+double DRAM_LATENCY_NS = 0.0;   // Độ trễ truy cập DRAM mỗi giao dịch (ns)
+int DRAM_LATENCY_CYCLES = 0;    // = ceil(DRAM_LATENCY_NS * SYSTEM_FREQ_MHZ / 1000)
+
+// --- MÔ PHỎNG BỘ NHỚ ---
+int8_t* ifm_dram;
+int8_t* weight_dram;
+int32_t* ofm_dram;
+tensor_mapping ifm_map, weight_map;     // ifm_dram / weight_dram ánh xạ từ file .bin (base = NULL: malloc)
+op_dump sim_op_dump;                    // Lớp đọc từ file dump op (sim_parse_args), op rỗng nếu không dùng
+
+// --- THÀNH PHẦN PHẦN CỨNG (lõi thời gian) ---
+sim_unit dma_engine;        // Kênh DMA 0: IFM (hoặc mọi luồng đọc khi chỉ có 1 kênh)
+sim_unit dma_weight_engine;
+sim_unit dma_ofm_engine;    // Hàng đợi ghi psum / OFM (luôn tách khỏi hàng đợi đọc)
+sim_unit pe_array;
+sim_buffer ifm_buf;
+sim_buffer weight_buf;
+
+// --- KÊNH DMA ---
+// SIM_DMA_CHANNELS=1 (mặc định): 1 DMA engine cho mọi luồng
+//                 =2           : kênh IFM (+ OFM/psum) và kênh weight
+//                 =3           : kênh IFM, weight, OFM/psum riêng
+// Nhiều kênh: mỗi kênh có hàng đợi + băng thông riêng (DMA_IFM_BYTES, DMA_WEIGHT_BYTES,
+// DMA_OFM_BYTES, mặc định = bus). Mọi hàng đợi dùng chung 1 cổng DRAM qua bộ phân xử (dram_port).
+// Psum / OFM luôn đi hàng đợi ghi riêng (dma_ofm_engine, băng thông của kênh chứa nó): lệnh ghi chờ
+// lượt tính xong nên nếu xếp chung hàng đợi đọc (in-order) sẽ chặn mọi lần prefetch phía sau.
+// Đọc và ghi vẫn không chạy cùng lúc vì cùng giữ cổng DRAM. Lệnh ghi được giữ lại (dma_store_pending)
+// tới khi lần nạp kế tiếp đã đặt cổng: prefetch thường sẵn sàng trước lệnh ghi nên được cấp cổng trước.
+enum { DMA_CH_IFM, DMA_CH_WEIGHT, DMA_CH_OFM, DMA_MAX_CH };
+sim_unit* dma_ch[DMA_MAX_CH];
+int dma_ch_bytes[DMA_MAX_CH];
+int dma_num_channels = 1;
+sim_port dram_port;
+typedef struct {
+    sim_time cycles, after;
+} sim_store;
+sim_store* dma_store_pending;           // Lệnh ghi psum / OFM chưa đặt cổng
+int dma_store_n = 0, dma_store_cap = 0;
+
+// --- SRAM ON-CHIP (bank conflict) ---
+sram_model ifm_sram;
+sram_model weight_sram;
+sram_model linebuf_sram;                        // Line buffer (WS + IS, tham số LINE_BUFFER): SRAM riêng
+unsigned long long sram_conflict_steps = 0;     // Số lượt tính bị kéo dài vì bank conflict
+unsigned long long sram_compute_stall = 0;      // Chu kỳ compute tăng thêm
+unsigned long long sram_dma_stall = 0;          // Chu kỳ DMA tăng thêm (cổng ghi chậm hơn bus)
+
+// --- BỘ NHỚ PHÂN CẤP (MEM_STATS) ---
+unsigned long long spad_read_bytes = 0;         // Byte PE đọc từ buffer on-chip (scratchpad)
+unsigned long long spad_write_bytes = 0;        // Byte DMA ghi vào buffer on-chip
+
+// --- PSUM / OFM ---
+// Mỗi lần cộng dồn psum int32 vào ofm_dram là 1 giao dịch trên hàng đợi ghi DMA_CH_OFM, chạy sau lượt tính:
+//   - pass đầu chỉ ghi (spill), các pass sau đọc (fill) + ghi; pass cuối ghi kết quả (writeback)
+//   - dataflow giữ psum on-chip qua mọi pass (Tiling, OS, Winograd) chỉ có writeback cuối
+// SIM_PSUM_BUF: dung lượng psum buffer on-chip (byte, mặc định 0). Tập psum cộng dồn dở của dataflow
+// (sim_psum_plan) vừa buffer -> fill / spill nằm trên chip, DRAM chỉ còn writeback cuối.
+// SIM_PSUM=0: bỏ qua toàn bộ lưu lượng psum / OFM (như mô hình cũ).
+int psum_enabled = 1;
+int psum_buf_bytes = 0;
+int psum_onchip = 0;
+unsigned long long psum_fill_bytes = 0, psum_spill_bytes = 0, ofm_write_bytes = 0;
+unsigned long long psum_dma_cycles = 0;         // Chu kỳ các giao dịch có fill / spill
+unsigned long long ofm_dma_cycles = 0;          // Chu kỳ các giao dịch chỉ writeback
+
+static inline int sim_env_int(const char* name, int def) {
+    const char* env = getenv(name);
+    return (env && atoi(env) > 0) ? atoi(env) : def;
+}
+
+// Số chu kỳ bus để truyền bytes byte
+static inline sim_time sim_bus_cycles(long long bytes) {
+    return (bytes + DRAM_BUS_WIDTH_BYTES - 1) / DRAM_BUS_WIDTH_BYTES;
+}
+
+// Số chu kỳ của 1 giao dịch DMA bytes byte gồm descs descriptor (mô hình tile): bus + khởi tạo + độ trễ DRAM
+static inline sim_time sim_xfer_cycles(long long bytes, int descs) {
+    return sim_bus_cycles(bytes) + (sim_time)descs * DMA_SETUP_CYCLES + DRAM_LATENCY_CYCLES;
+}
+
+// 1 nếu mỗi giao dịch DMA tốn đúng sim_xfer_cycles: không SIM_DRAM / SIM_GLB / SIM_SRAM, 1 kênh
+static inline int sim_dma_analytic() {
+    return !dram.enabled && !glb.enabled && !sram_cfg.enabled && dma_num_channels == 1;
+}
+
+// DESCRIPTOR CHO CÁC MẪU TRUY CẬP CỦA CONV (common/dma_desc.h)
+
+// Cửa sổ IFM rows hàng x cols cột x nc channel, góc trên trái (hi0, wi0), channel đầu c0 -> dst
+// Layout đích [hàng][cột][channel] với bước dst_row / dst_col byte (channel liền nhau).
+// Phần nằm ngoài ảnh (padding) ghi 0; phần trong ảnh là 1 descriptor 3D. Trả về số byte đọc từ DRAM
+static inline long long sim_desc_ifm(int8_t* dst, int hi0, int wi0, int c0, int nc, int rows, int cols,
+                                     long long dst_row, long long dst_col) {
+    int r0 = (hi0 < 0) ? -hi0 : 0;
+    int r1 = (INPUT_H - hi0 < rows) ? INPUT_H - hi0 : rows;
+    int k0 = (wi0 < 0) ? -wi0 : 0;
+    int k1 = (INPUT_W - wi0 < cols) ? INPUT_W - wi0 : cols;
+    if (r0 > 0 || r1 < rows || k0 > 0 || k1 < cols) {
+        for (int r = 0; r < rows; r++)
+            for (int k = 0; k < cols; k++) memset(dst + r * dst_row + k * dst_col, 0, nc);
+    }
+    if (r1 <= r0 || k1 <= k0) return 0;
+    dma_desc d = { DRAM_IFM, ifm_dram, ((long long)(hi0 + r0) * INPUT_W + (wi0 + k0)) * INPUT_C + c0,
+                   dst + r0 * dst_row + k0 * dst_col, { nc, k1 - k0, r1 - r0 },
+                   { 1, INPUT_C, (long long)INPUT_W * INPUT_C }, { 1, dst_col, dst_row } };
+    return dma_desc_run(d);
+}
+
+// Weight của filter f, channel [c0, c0 + nc), mọi (kh, kw) -> dst, layout [kh*KERNEL_W + kw][channel]
+// với bước dst_k byte giữa 2 vị trí kernel. 1 descriptor 2D (bước OUTPUT_F giữa các channel)
+static inline long long sim_desc_weight(int8_t* dst, int f, int c0, int nc, long long dst_k) {
+    dma_desc d = { DRAM_WEIGHT, weight_dram, (long long)c0 * OUTPUT_F + f, dst,
+                   { 1, nc, KERNEL_H * KERNEL_W },
+                   { 1, OUTPUT_F, (long long)INPUT_C * OUTPUT_F }, { 1, 1, dst_k } };
+    return dma_desc_run(d);
+}
+
+// Đọc 1 byte IFM / Weight từ DRAM trong hàm DMA (ghi lại địa chỉ cho mô hình DRAM, qua GLB nếu có)
+static inline int8_t ifm_read(int idx) {
+    glb_read(DRAM_IFM, idx, 1);
+    return ifm_dram[idx];
+}
+
+static inline int8_t weight_read(int idx) {
+    glb_read(DRAM_WEIGHT, idx, 1);
+    return weight_dram[idx];
+}
+
+static inline sram_model* sim_buf_sram(sim_buffer* b) {
+    if (b == &ifm_buf) return &ifm_sram;
+    if (b == &weight_buf) return &weight_sram;
+    return 0;
+}
+
+static inline int sim_buf_region(sim_buffer* b) {
+    return (b == &weight_buf) ? DRAM_WEIGHT : (b == &ifm_buf) ? DRAM_IFM : DRAM_OFM;
+}
+
+// Không hàng đợi nào còn bắt đầu được trước thời điểm rảnh sớm nhất của các hàng đợi
+// (lệnh ghi còn phải chờ lượt tính đã phát xong)
+static inline void sim_dma_prune() {
+    sim_time floor = dma_engine.free_at;
+    if (dma_num_channels > 1 && dma_weight_engine.free_at < floor) floor = dma_weight_engine.free_at;
+    sim_time wr = (dma_ofm_engine.free_at > pe_array.free_at) ? dma_ofm_engine.free_at : pe_array.free_at;
+    if (wr < floor) floor = wr;
+    sim_port_prune(&dram_port, floor);
+}
+
+// Đặt cổng cho các lệnh ghi đang chờ (sau lần nạp vừa phát, hoặc cuối mô phỏng)
+static inline void sim_dma_flush_stores() {
+    for (int i = 0; i < dma_store_n; i++) {
+        sim_dma_store(dma_ch[DMA_CH_OFM], &dram_port, dma_store_pending[i].cycles, dma_store_pending[i].after);
+    }
+    dma_store_n = 0;
+    sim_dma_prune();
+}
+
+// 1 giao dịch DMA qua kênh ch, nạp bytes byte vào buffer a (và b, nếu IFM + Weight chung 1 lần truyền)
+// Chu kỳ = max(cổng DRAM, cổng GLB, băng thông kênh, cổng ghi SRAM):
+//   - Cổng DRAM: ceil(bytes / bus), hoặc mô hình burst/row buffer (SIM_DRAM=1) trên địa chỉ đã đọc
+//     (SIM_GLB=1: chỉ byte nạp line GLB + byte đi thẳng mới ra DRAM)
+//   - GLB: ceil(byte đọc / GLB_BW) (SIM_GLB=1)
+//   - Kênh: ceil(bytes / băng thông kênh) khi có nhiều kênh
+//   - SRAM: số chu kỳ ghi của các vùng vừa sram_touch (SIM_SRAM=1)
+// Trả về số chu kỳ của giao dịch
+static inline sim_time sim_dma_load(int ch, long long bytes, sim_buffer* a, sim_buffer* b) {
+    sim_time cycles;
+    unsigned long long bursts = dram.burst_count;
+    unsigned long long dram_bytes = bytes, glb_rd = 0, glb_fill = 0, glb_bypass = 0;
+    if (glb.enabled) {
+        glb_take(sim_buf_region(a), &glb_rd, &glb_fill, &glb_bypass);
+        if (b) glb_take(sim_buf_region(b), &glb_rd, &glb_fill, &glb_bypass);
+        dram_bytes = glb_fill + glb_bypass;
+    }
+    if (!dram.enabled) cycles = sim_bus_cycles(dram_bytes);
+    else if (b) cycles = dram_flush();
+    else cycles = dram_flush_region(sim_buf_region(a));
+    if (glb.enabled) {
+        sim_time g = glb_cycles(glb_rd, glb_fill);
+        if (g > cycles) cycles = g;
+    }
+
+    // Năng lượng: byte trên bus DRAM (cả burst khi SIM_DRAM=1) + byte đọc/nạp GLB + byte ghi vào buffer
+    energy_dram(dram.enabled ? (dram.burst_count - bursts) * DRAM_BURST_BYTES : dram_bytes);
+    energy_glb(glb_rd + glb_fill);
+    energy_sram(bytes);
+    spad_write_bytes += bytes;
+
+    if (dma_num_channels > 1) {
+        sim_time ch_cycles = (bytes + dma_ch_bytes[ch] - 1) / dma_ch_bytes[ch];
+        if (ch_cycles > cycles) cycles = ch_cycles;
+    }
+
+    sim_time w = sram_flush(sim_buf_sram(a), 1);
+    if (b) {
+        sim_time w2 = sram_flush(sim_buf_sram(b), 1);
+        if (w2 > w) w = w2;
+    }
+    // Giao dịch nạp line buffer ghi vào linebuf_sram thay cho buffer a (0 nếu không chạm)
+    sim_time w3 = sram_flush(&linebuf_sram, 1);
+    if (w3 > w) w = w3;
+    if (w > cycles) {
+        sram_dma_stall += w - cycles;
+        cycles = w;
+    }
+    // Khởi tạo các descriptor của giao dịch + độ trễ DRAM (không pipeline với phần truyền)
+    cycles += (sim_time)dma_desc_take() * DMA_SETUP_CYCLES + DRAM_LATENCY_CYCLES;
+
+    sim_dma_port(dma_ch[ch], &dram_port, cycles, a, b);
+    sim_dma_flush_stores();
+    return cycles;
+}
+
+// 1 giao dịch vùng OFM trên hàng đợi ghi: bytes byte (đọc psum + ghi), bắt đầu sau lượt tính cuối
+// Địa chỉ đã được dram_touch. Trả về số chu kỳ của giao dịch
+static inline sim_time sim_dma_ofm(long long bytes) {
+    sim_time cycles;
+    unsigned long long bursts = dram.burst_count;
+    cycles = dram.enabled ? dram_flush_region(DRAM_OFM) : sim_bus_cycles(bytes);
+    energy_dram(dram.enabled ? (dram.burst_count - bursts) * DRAM_BURST_BYTES : (unsigned long long)bytes);
+    if (dma_num_channels > 1) {
+        sim_time ch_cycles = (bytes + dma_ch_bytes[DMA_CH_OFM] - 1) / dma_ch_bytes[DMA_CH_OFM];
+        if (ch_cycles > cycles) cycles = ch_cycles;
+    }
+    // 1 descriptor liền nhau
+    cycles += DMA_SETUP_CYCLES + DRAM_LATENCY_CYCLES;
+    // Chờ lần nạp kế tiếp đặt cổng trước (sim_dma_flush_stores)
+    if (dma_store_n == dma_store_cap) {
+        dma_store_cap = dma_store_cap ? dma_store_cap * 2 : 16;
+        dma_store_pending = (sim_store*)realloc(dma_store_pending, dma_store_cap * sizeof(sim_store));
+    }
+    dma_store_pending[dma_store_n].cycles = cycles;
+    dma_store_pending[dma_store_n].after = pe_array.free_at;
+    dma_store_n++;
+    return cycles;
+}
+
+// Dataflow báo số byte psum cộng dồn dở qua các pass; trả về 1 nếu psum buffer on-chip giữ được
+static inline int sim_psum_plan(long long bytes) {
+    psum_onchip = (bytes <= psum_buf_bytes);
+    return psum_onchip;
+}
+
+// Cộng dồn count psum int32 liên tiếp bắt đầu từ ofm_dram[idx] (gọi sau lượt tính tạo ra chúng)
+// first: pass đầu (chưa có psum cũ), last: pass cuối (kết quả cuối cùng)
+static inline void sim_psum_update(long long idx, int count, int first, int last) {
+    if (!psum_enabled || count <= 0) return;
+    long long offset = idx * (long long)sizeof(int32_t);
+    long long bytes = (long long)count * sizeof(int32_t);
+    if (psum_onchip) {
+        // Đọc-sửa-ghi trong psum buffer, chỉ kết quả cuối ra DRAM
+        energy_sram(first ? bytes : 2 * bytes);
+        if (!last) return;
+        dram_touch(DRAM_OFM, offset, bytes);
+        ofm_write_bytes += bytes;
+        ofm_dma_cycles += sim_dma_ofm(bytes);
+        return;
+    }
+    long long total = bytes;
+    if (!first) {
+        dram_touch(DRAM_OFM, offset, bytes);
+        psum_fill_bytes += bytes;
+        total += bytes;
+    }
+    dram_touch(DRAM_OFM, offset, bytes);
+    if (last) ofm_write_bytes += bytes;
+    else psum_spill_bytes += bytes;
+    sim_time cycles = sim_dma_ofm(total);
+    if (first && last) ofm_dma_cycles += cycles;
+    else psum_dma_cycles += cycles;
+}
+
+// Mô hình tile (common/tiling_planner.h): chu kỳ DMA của 1 lần sim_psum_update(count, first, last)
+// khi tập psum cộng dồn dở của tile là live byte (cùng phép so với psum buffer như sim_psum_plan)
+static inline sim_time sim_psum_xfer_cycles(long long count, int first, int last, long long live) {
+    if (!psum_enabled || count <= 0) return 0;
+    long long bytes = count * (long long)sizeof(int32_t);
+    if (live <= psum_buf_bytes) return last ? sim_xfer_cycles(bytes, 1) : 0;
+    return sim_xfer_cycles(first ? bytes : 2 * bytes, 1);
+}
+
+// Năng lượng 1 lượt tính: macs phép MAC (kèm truy cập thanh ghi), sram_bytes byte đọc từ buffer
+static inline void sim_pe_energy(unsigned long long macs, unsigned long long sram_bytes) {
+    energy_mac(macs);
+    energy_sram(sram_bytes);
+    spad_read_bytes += sram_bytes;
+}
+
+// Lượt tính của mảng PE: chu kỳ = max(compute, cổng đọc của ifm_sram / weight_sram)
+static inline sim_time sim_read_cycles(sim_time cycles) {
+    sim_time r = sram_flush(&ifm_sram, 0);
+    sim_time r2 = sram_flush(&weight_sram, 0);
+    if (r2 > r) r = r2;
+    if (r <= cycles) return cycles;
+    sram_conflict_steps++;
+    sram_compute_stall += r - cycles;
+    return r;
+}
+
+// Lấy 10 tham số lớp từ file dump op (common/op_dump.h). Trả về 0 nếu thành công, -1 (đã in lỗi) nếu không
+int sim_load_op_dump(const char* path) {
+    if (op_dump_load(path, &sim_op_dump) < 0) {
+        printf("Error: Could not open %s\n", path);
+        return -1;
+    }
+    if (op_dump_layer(&sim_op_dump, path) < 0) return -1;
+    const op_dump* d = &sim_op_dump;
+    if (d->stride_h != d->stride_w || d->pad_top != d->pad_left) {
+        printf("Warning: %s has stride (%d, %d), padding (%d, %d) - simulating stride %d, padding %d\n", path,
+               d->stride_h, d->stride_w, d->pad_top, d->pad_left, d->stride_h, d->pad_top);
+    }
+    INPUT_H = d->in_h, INPUT_W = d->in_w, INPUT_C = d->in_c;
+    KERNEL_H = d->k_h, KERNEL_W = d->k_w;
+    OUTPUT_F = d->out_f, OUTPUT_H = d->out_h, OUTPUT_W = d->out_w;
+    STRIDE = d->stride_h;
+    PADDING = d->pad_top;       // SAME lệch: phần lẻ dưới / phải là hàng / cột ngoài IFM (= 0)
+    printf("--- %s %s #%d: %d %d %d %d %d %d %d %d %d %d ---\n", d->model, d->op, d->op_index, INPUT_H, INPUT_W,
+           INPUT_C, KERNEL_H, KERNEL_W, OUTPUT_F, OUTPUT_H, OUTPUT_W, STRIDE, PADDING);
+    return 0;
+}
+
+// Đọc 13 tham số chung + tính PARALLEL_CHANNELS. extra_usage: mô tả tham số riêng (có thể "").
+// Tham số đầu không phải số: file dump op thay cho 10 tham số lớp (<op_dump.txt> NPE MAC BUF).
+// Trả về chỉ số của tham số riêng đầu tiên (14, hoặc 5 khi dùng file dump), -1 nếu lỗi
+int sim_parse_args(int argc, char* argv[], const char* extra_usage) {
+    int dump = argc > 1 && (argv[1][0] < '0' || argv[1][0] > '9');
+    int hw = dump ? 2 : 11;     // Vị trí NPE
+    // Kiểm tra tham số (13 số + 1 tên file = 14)
+    if (argc < hw + 3) {
+        printf("Usage: %s IH IW IC KH KW OF OH OW S P NPE MAC BUF%s\n", argv[0], extra_usage);
+        printf("       %s <op_dump.txt> NPE MAC BUF%s\n", argv[0], extra_usage);
+        return -1;
+    }
+
+    if (dump) {
+        if (sim_load_op_dump(argv[1]) < 0) return -1;
+    } else {
+        INPUT_H = atoi(argv[1]);
+        INPUT_W = atoi(argv[2]);
+        INPUT_C = atoi(argv[3]);
+        KERNEL_H = atoi(argv[4]);
+        KERNEL_W = atoi(argv[5]);
+        OUTPUT_F = atoi(argv[6]);
+        OUTPUT_H = atoi(argv[7]);
+        OUTPUT_W = atoi(argv[8]);
+        STRIDE = atoi(argv[9]);
+        PADDING = atoi(argv[10]);
+    }
+    NUM_PE = atoi(argv[hw]);
+    MACS_PER_PE = atoi(argv[hw + 1]);
+    BUFFER_SIZE_BYTES = atoi(argv[hw + 2]);
+
+    // Tự động tính PARALLEL_CHANNELS
+    // Logic: Tổng số MAC / kích thước 1 channel
+    // Ví dụ: (48 * 3) / (3 * 3) = 144 / 9 = 16
+    int kernel_size = KERNEL_H * KERNEL_W;
+    if (kernel_size > 0) {
+        PARALLEL_CHANNELS = (NUM_PE * MACS_PER_PE) / kernel_size;
+    } else {
+        PARALLEL_CHANNELS = 1; // Tránh chia cho 0
+    }
+
+    // Tham số bộ nhớ / xung nhịp (cần trước khi lập kế hoạch tiling)
+    DRAM_BUS_WIDTH_BYTES = sim_env_int("SIM_BUS_BYTES", 8);
+    PE_COMPUTE_CYCLES = sim_env_int("SIM_PE_CYCLES", 1);
+    const char* env = getenv("SIM_FREQ_MHZ");
+    SYSTEM_FREQ_MHZ = (env && atof(env) > 0.0) ? atof(env) : 100.0;
+    env = getenv("SIM_DRAM_NS");
+    DRAM_LATENCY_NS = (env && atof(env) > 0.0) ? atof(env) : 0.0;
+    DMA_SETUP_CYCLES = sim_env_int("SIM_DMA_SETUP", 0);
+    DRAM_LATENCY_CYCLES = (int)ceil(DRAM_LATENCY_NS * SYSTEM_FREQ_MHZ / 1000.0);
+    // Psum (mô hình tile tính cả lưu lượng psum: sim_psum_xfer_cycles)
+    env = getenv("SIM_PSUM");
+    psum_enabled = !(env && atoi(env) == 0);
+    psum_buf_bytes = sim_env_int("SIM_PSUM_BUF", 0);
+    return hw + 3;
+}
+
+// Chọn tile vừa BUFFER_SIZE_BYTES (gọi sau sim_parse_args, trước khi cấp phát buffer)
+// tc <= PARALLEL_CHANNELS ban đầu (và <= INPUT_C); th, tw, tf <= max_th, max_tw, max_tf
+// model: hàm mô hình của dataflow. Trả về -1 (đã in lỗi) nếu cấu hình không vừa
+int sim_plan_tiling(int max_th, int max_tw, int max_tf, plan_model_fn model) {
+    if (PARALLEL_CHANNELS < 1) {
+        printf("Error: PE array (%d x %d MAC) is smaller than one %dx%d kernel\n",
+               NUM_PE, MACS_PER_PE, KERNEL_H, KERNEL_W);
+        return -1;
+    }
+    tile_plan max = { PARALLEL_CHANNELS, max_th, max_tw, max_tf, 0, 0, 0, 0 };
+    if (max.tc > INPUT_C) max.tc = INPUT_C;
+    if (plan_or_reject(&sim_plan, &max, BUFFER_SIZE_BYTES, model) < 0) return -1;
+    PARALLEL_CHANNELS = sim_plan.tc;
+    return 0;
+}
+
+// Zero-copy: ánh xạ file tensor int8 đúng layout / shape của DRAM mô phỏng làm mảng DRAM (chỉ đọc).
+// NULL nếu SIM_MMAP=0, không có file, không mmap được hoặc không khớp -> đọc vào bộ nhớ cấp phát
+int8_t* dram_map_bin(const char* path, tensor_mapping* m, int layout, int ndim, const int* dims) {
+    const char* env = getenv("SIM_MMAP");
+    if (env && atoi(env) == 0) return NULL;
+    tensor_header h;
+    const void* data = tensor_map(path, &h, m);
+    if (data && !tensor_match(&h, TENSOR_I8, layout, ndim, dims)) {
+        tensor_unmap(m);
+        data = NULL;
+    }
+    return (int8_t*)data;
+}
+
+// IFM từ file tensor: layout NHWC, đúng H x W x C -> đọc thẳng vào ifm_dram. Trả về 1 nếu thành công
+int dram_load_ifm_bin(const char* path) {
+    tensor_header h;
+    FILE* f = tensor_open(path, &h);
+    if (!f) return 0;
+    int dims[3] = { INPUT_H, INPUT_W, INPUT_C };
+    size_t bytes = (size_t)INPUT_H * INPUT_W * INPUT_C;
+    int ok = tensor_check(path, &h, TENSOR_I8, TENSOR_NHWC, 3, dims) && fread(ifm_dram, 1, bytes, f) == bytes;
+    fclose(f);
+    return ok;
+}
+
+// Weight thứ tự F->KH->KW->C (OHWI: weights.txt / file tensor OHWI) -> weight_dram [kh][kw][c][f]
+void dram_weight_from_ohwi(const int8_t* w) {
+    int k_size = KERNEL_H * KERNEL_W * INPUT_C;
+    for (int f = 0; f < OUTPUT_F; f++)
+        for (int k = 0; k < k_size; k++) weight_dram[k * OUTPUT_F + f] = w[(long long)f * k_size + k];
+}
+
+// Weight từ file tensor: HWIO đọc thẳng, OHWI (thứ tự weights.txt) sắp lại sang [kh][kw][c][f].
+// File có thể chứa nhiều filter hơn OUTPUT_F (chỉ lấy OUTPUT_F filter đầu, như bản text)
+int dram_load_weight_bin(const char* path) {
+    tensor_header h;
+    int8_t* w = (int8_t*)tensor_load(path, &h);
+    if (!w) return 0;
+    int ok = 0;
+    if (h.layout == TENSOR_OHWI) {
+        int dims[4] = { -1, KERNEL_H, KERNEL_W, INPUT_C };
+        ok = tensor_check(path, &h, TENSOR_I8, TENSOR_OHWI, 4, dims) && (int)h.dims[0] >= OUTPUT_F;
+        if (ok) dram_weight_from_ohwi(w);
+    } else {
+        int dims[4] = { KERNEL_H, KERNEL_W, INPUT_C, OUTPUT_F };
+        ok = tensor_check(path, &h, TENSOR_I8, TENSOR_HWIO, 4, dims);
+        if (ok) memcpy(weight_dram, w, (size_t)KERNEL_H * KERNEL_W * INPUT_C * OUTPUT_F);
+    }
+    free(w);
+    return ok;
+}
+
+// IFM từ .npy (int8 / int16 / int32 từ Python): shape (H, W, C) hoặc (1, H, W, C). Trả về 1 nếu thành công
+int dram_load_ifm_npy(const char* path) {
+    tensor_header h;
+    int8_t* x = (int8_t*)tensor_load_npy(path, &h, TENSOR_I8);
+    if (!x) return 0;
+    if (h.ndim == 4 && h.dims[0] == 1) {
+        h.dims[0] = h.dims[1], h.dims[1] = h.dims[2], h.dims[2] = h.dims[3], h.dims[3] = 1;
+        h.ndim = 3;
+    }
+    int dims[3] = { INPUT_H, INPUT_W, INPUT_C };
+    int ok = tensor_check(path, &h, TENSOR_I8, TENSOR_NHWC, 3, dims);
+    if (ok) memcpy(ifm_dram, x, (size_t)INPUT_H * INPUT_W * INPUT_C);
+    free(x);
+    return ok;
+}
+
+// Weight từ .npy: (KH, KW, C, F') = HWCF như script Python (ưu tiên) hoặc (F', KH, KW, C) như weights.txt,
+// F' >= OUTPUT_F (chỉ lấy OUTPUT_F filter đầu)
+int dram_load_weight_npy(const char* path) {
+    tensor_header h;
+    int8_t* w = (int8_t*)tensor_load_npy(path, &h, TENSOR_I8);
+    if (!w) return 0;
+    int hwcf[4] = { KERNEL_H, KERNEL_W, INPUT_C, -1 };
+    int ohwi[4] = { -1, KERNEL_H, KERNEL_W, INPUT_C };
+    int ok = 1;
+    if (tensor_match(&h, TENSOR_I8, TENSOR_NHWC, 4, hwcf) && (int)h.dims[3] >= OUTPUT_F) {
+        int k_size = KERNEL_H * KERNEL_W * INPUT_C, f_num = h.dims[3];
+        for (int k = 0; k < k_size; k++)
+            memcpy(weight_dram + (long long)k * OUTPUT_F, w + (long long)k * f_num, OUTPUT_F);
+    } else if (tensor_match(&h, TENSOR_I8, TENSOR_NHWC, 4, ohwi) && (int)h.dims[0] >= OUTPUT_F) {
+        dram_weight_from_ohwi(w);
+    } else {
+        printf("Error: %s has shape [%u, %u, %u, %u] - expected (%d, %d, %d, F) or (F, %d, %d, %d) with F >= %d\n",
+               path, h.dims[0], h.dims[1], h.dims[2], h.dims[3], KERNEL_H, KERNEL_W, INPUT_C, KERNEL_H, KERNEL_W,
+               INPUT_C, OUTPUT_F);
+        ok = 0;
+    }
+    free(w);
+    return ok;
+}
+
+// IFM / Weight từ file dump op: IFM NHWC chép thẳng, Weight OHWI sắp lại sang [kh][kw][c][f]
+void dram_load_op_dump() {
+    const op_dump_tensor* x = &sim_op_dump.t[OP_DUMP_IFM];
+    const op_dump_tensor* w = &sim_op_dump.t[OP_DUMP_WEIGHTS];
+    ifm_dram = (int8_t*)calloc(INPUT_H * INPUT_W * INPUT_C, 1);
+    weight_dram = (int8_t*)calloc(KERNEL_H * KERNEL_W * INPUT_C * OUTPUT_F, 1);
+    if (x->data && x->dtype == TENSOR_I8) memcpy(ifm_dram, x->data, (size_t)INPUT_H * INPUT_W * INPUT_C);
+    else printf("Warning: op dump has no int8 IFM values, IFM is 0\n");
+    if (w->data && w->dtype == TENSOR_I8) dram_weight_from_ohwi((const int8_t*)w->data);
+    else printf("Warning: op dump has no int8 WEIGHTS values, weights are 0\n");
+}
+
+void dram_init() {
+    if (sim_op_dump.op[0]) {
+        dram_load_op_dump();
+        ofm_dram = (int32_t*)calloc(OUTPUT_H * OUTPUT_W * OUTPUT_F, sizeof(int32_t));
+        return;
+    }
+    // Load IFM (ưu tiên file nhị phân: mmap, rồi đọc vào bộ nhớ, rồi .npy, cuối cùng mới parse text)
+    int ifm_dims[3] = { INPUT_H, INPUT_W, INPUT_C };
+    ifm_dram = dram_map_bin("../params/ifm.bin", &ifm_map, TENSOR_NHWC, 3, ifm_dims);
+    if (!ifm_dram) {
+        ifm_dram = (int8_t*)malloc(INPUT_H * INPUT_W * INPUT_C);
+        // Text: thứ tự [h, w, c] trùng ifm_dram -> quét thẳng vào
+        if (!dram_load_ifm_bin("../params/ifm.bin") && !dram_load_ifm_npy("../params/ifm.npy") &&
+            tensor_read_text("../params/ifm.txt", TENSOR_I8, (long long)INPUT_H * INPUT_W * INPUT_C, ifm_dram) < 0) {
+            printf("Error: Could not open ../params/ifm.txt\n");
+            memset(ifm_dram, 1, INPUT_H * INPUT_W * INPUT_C);
+        }
+    }
+
+    // Load Weights (file: F->H->W->C, DRAM: [h, w, c, f]); chỉ file HWIO mới mmap thẳng được
+    int w_dims[4] = { KERNEL_H, KERNEL_W, INPUT_C, OUTPUT_F };
+    weight_dram = dram_map_bin("../params/weights.bin", &weight_map, TENSOR_HWIO, 4, w_dims);
+    if (!weight_dram) {
+        weight_dram = (int8_t*)calloc(KERNEL_H * KERNEL_W * INPUT_C * OUTPUT_F, 1);
+        if (!dram_load_weight_bin("../params/weights.bin") && !dram_load_weight_npy("../params/weights.npy")) {
+            // Text: OUTPUT_F filter đầu (thiếu dòng -> 0) rồi sắp lại sang [h, w, c, f]
+            int8_t* w = (int8_t*)calloc(KERNEL_H * KERNEL_W * INPUT_C * OUTPUT_F, 1);
+            if (tensor_read_text("../params/weights.txt", TENSOR_I8,
+                                 (long long)KERNEL_H * KERNEL_W * INPUT_C * OUTPUT_F, w) >= 0) {
+                dram_weight_from_ohwi(w);
+            }
+            free(w);
+        }
+    }
+
+    ofm_dram = (int32_t*)calloc(OUTPUT_H * OUTPUT_W * OUTPUT_F, sizeof(int32_t));
+}
+
+// SIM_OFM_FORMAT=txt (mặc định) / bin / npy / both (= txt + bin), ghép được (vd bin,npy):
+// ghi ../ofm/ofm.txt, ../ofm/ofm.bin, ../ofm/ofm.npy (int32, NHWC, shape (H, W, F))
+void write_dram_to_file() {
+    int txt, bin, npy;
+    tensor_ofm_formats(&txt, &bin, &npy);
+    int dims[3] = { OUTPUT_H, OUTPUT_W, OUTPUT_F };
+    if (bin) {
+        tensor_header h = tensor_header_make(TENSOR_I32, TENSOR_NHWC, 3, dims);
+        if (tensor_save("../ofm/ofm.bin", &h, ofm_dram) < 0) printf("Error: Could not write ../ofm/ofm.bin\n");
+    }
+    if (npy && tensor_save_npy("../ofm/ofm.npy", TENSOR_I32, 3, dims, ofm_dram) < 0) {
+        printf("Error: Could not write ../ofm/ofm.npy\n");
+    }
+    if (!txt) return;
+    FILE* f = fopen("../ofm/ofm.txt", "w");
+    if (!f) return;
+    for(int i=0; i<OUTPUT_H*OUTPUT_W*OUTPUT_F; i++) fprintf(f, "%d\n", ofm_dram[i]);
+    fclose(f);
+}
+
+// Khởi tạo lõi thời gian + các thành phần (gọi trước controller)
+void sim_init() {
+    sim_timing_init();
+    dram_model_init(DRAM_BUS_WIDTH_BYTES);
+    sram_config_init(BUFFER_SIZE_BYTES);
+    energy_model_init();
+    glb_init();
+    pe_util_init(NUM_PE, MACS_PER_PE);
+    pe_timing_init(NUM_PE, MACS_PER_PE);
+    dma_desc_pending = 0;
+    dma_desc_issued = 0;
+    dma_store_n = 0;
+    psum_onchip = 0;
+    sram_init(&ifm_sram, "ifm");
+    sram_init(&weight_sram, "weight");
+    sram_init(&linebuf_sram, "linebuf");
+    sim_unit_init(&dma_engine, "dma");
+    sim_unit_init(&dma_weight_engine, "dma_weight");
+    sim_unit_init(&dma_ofm_engine, "dma_ofm");
+    sim_port_init(&dram_port, "port");
+    dma_num_channels = sim_env_int("SIM_DMA_CHANNELS", 1);
+    if (dma_num_channels > DMA_MAX_CH) dma_num_channels = DMA_MAX_CH;
+    dma_ch[DMA_CH_IFM] = &dma_engine;
+    dma_ch[DMA_CH_WEIGHT] = (dma_num_channels > 1) ? &dma_weight_engine : &dma_engine;
+    dma_ch[DMA_CH_OFM] = &dma_ofm_engine;
+    dma_ch_bytes[DMA_CH_IFM] = sim_env_int("DMA_IFM_BYTES", DRAM_BUS_WIDTH_BYTES);
+    dma_ch_bytes[DMA_CH_WEIGHT] = sim_env_int("DMA_WEIGHT_BYTES", DRAM_BUS_WIDTH_BYTES);
+    // 2 kênh: hàng đợi ghi thuộc kênh IFM
+    dma_ch_bytes[DMA_CH_OFM] = (dma_num_channels > 2) ? sim_env_int("DMA_OFM_BYTES", DRAM_BUS_WIDTH_BYTES)
+                                                      : dma_ch_bytes[DMA_CH_IFM];
+    sim_unit_init(&pe_array, "pe");
+    sim_buffer_init(&ifm_buf, "ifm");
+    sim_buffer_init(&weight_buf, "weight");
+}
+
+// SURVEY_RESULT,DMA,COMPUTE,TOTAL,ENERGY,E_DRAM,E_SRAM,E_REG,E_MAC
+//   TOTAL = thời điểm xong của yêu cầu cuối cùng, năng lượng tính bằng pJ
+//   E_SRAM = buffer on-chip + GLB (tách riêng trong MEM_STATS)
+// Khi SIM_OVERLAP=1 in thêm:
+//   OVERLAP_STATS,tuần tự,chồng lấp,PE chờ DMA,DMA chờ bank,fill,drain,số lượt PE
+void sim_report() {
+    sim_dma_flush_stores();
+    sim_time total = sim_end_time();
+    // DMA = tổng chu kỳ làm việc của mọi hàng đợi (kênh chưa dùng có busy = 0)
+    sim_unit* chans[DMA_MAX_CH] = { &dma_engine, &dma_weight_engine, &dma_ofm_engine };
+    sim_time dma_busy = 0, dma_wait = 0, dma_end = 0;
+    for (int i = 0; i < DMA_MAX_CH; i++) {
+        dma_busy += chans[i]->busy;
+        // Hàng đợi ghi chờ lượt tính chứ không chờ bank: không tính vào DMA chờ bank
+        if (chans[i] != &dma_ofm_engine) dma_wait += chans[i]->wait;
+        if (chans[i]->free_at > dma_end) dma_end = chans[i]->free_at;
+    }
+    printf("SURVEY_RESULT,%llu,%llu,%llu,%.1f,%.1f,%.1f,%.1f,%.1f\n", dma_busy, pe_array.busy, total,
+           energy_total(), energy_dram_total(), energy_sram_total() + energy_glb_total(),
+           energy_reg_total(), energy_mac_total());
+    if (sim_overlap) {
+        sim_time drain = (total > dma_end) ? total - dma_end : 0;
+        printf("OVERLAP_STATS,%llu,%llu,%llu,%llu,%llu,%llu,%llu\n",
+               dma_busy + pe_array.busy, total, pe_array.wait, dma_wait,
+               pe_array.first_start, drain, pe_array.ops);
+    }
+    // Khi có nhiều kênh: DMA_STATS,kênh,bận,rảnh,chờ cổng DRAM,số giao dịch
+    // (1 dòng / kênh đọc + hàng đợi ghi + cổng)
+    if (dma_num_channels > 1) {
+        for (int i = 0; i < DMA_MAX_CH; i++) {
+            if (i >= dma_num_channels && chans[i] != &dma_ofm_engine) continue;
+            printf("DMA_STATS,%s,%llu,%llu,%llu,%llu\n", chans[i]->name, chans[i]->busy,
+                   total - chans[i]->busy, chans[i]->contention, chans[i]->ops);
+        }
+        printf("DMA_STATS,%s,%llu,%llu,0,%llu\n", dram_port.name, dram_port.busy_cycles,
+               total - dram_port.busy_cycles, dram_port.grants);
+    }
+    dram_model_report();
+    pe_util_report(pe_array.busy);
+    pe_timing_report(pe_array.busy, pe_util.active_macs);
+    // TIME_STATS,MHz,byte bus,chu kỳ / lượt PE,chu kỳ overhead / giao dịch 1 descriptor,tổng (us),DMA (us),
+    //            compute (us),số descriptor
+    printf("TIME_STATS,%.1f,%d,%d,%d,%.3f,%.3f,%.3f,%llu\n", SYSTEM_FREQ_MHZ, DRAM_BUS_WIDTH_BYTES, PE_COMPUTE_CYCLES,
+           DMA_SETUP_CYCLES + DRAM_LATENCY_CYCLES, total / SYSTEM_FREQ_MHZ, dma_busy / SYSTEM_FREQ_MHZ,
+           pe_array.busy / SYSTEM_FREQ_MHZ, dma_desc_issued);
+    // SRAM_STATS,bank,byte/cổng,word đọc IFM,word đọc weight,word ghi,lượt bị conflict,stall compute,stall DMA
+    if (sram_cfg.enabled) {
+        printf("SRAM_STATS,%d,%d,%llu,%llu,%llu,%llu,%llu,%llu\n", sram_cfg.banks, sram_cfg.port_bytes,
+               ifm_sram.read_words, weight_sram.read_words,
+               ifm_sram.write_words + weight_sram.write_words + linebuf_sram.write_words,
+               sram_conflict_steps, sram_compute_stall, sram_dma_stall);
+    }
+    if (sim_env_int("SIM_PLAN", 0)) plan_report(&sim_plan);
+    // PSUM_STATS,byte fill,byte spill,byte writeback,chu kỳ DMA psum,chu kỳ DMA writeback,psum on-chip
+    if (psum_enabled) {
+        printf("PSUM_STATS,%llu,%llu,%llu,%llu,%llu,%d\n", psum_fill_bytes, psum_spill_bytes, ofm_write_bytes,
+               psum_dma_cycles, ofm_dma_cycles, psum_onchip);
+    }
+    // MEM_STATS,tầng,dung lượng (byte),byte đọc,byte ghi,năng lượng (pJ) (1 dòng / tầng, thanh ghi tính theo lần truy cập)
+    // GLB_STATS,line IFM,line weight,hit IFM,trượt IFM,hit weight,trượt weight
+    if (glb.enabled) {
+        printf("MEM_STATS,dram,0,%llu,0,%.1f\n", energy.dram_bytes, energy_dram_total());
+        printf("MEM_STATS,glb,%d,%llu,%llu,%.1f\n", glb.capacity, glb.read_bytes, glb.fill_bytes, energy_glb_total());
+        printf("MEM_STATS,spad,%lld,%llu,%llu,%.1f\n", 2LL * BUFFER_SIZE_BYTES, spad_read_bytes, spad_write_bytes,
+               energy_sram_total());
+        printf("MEM_STATS,reg,%d,%llu,%llu,%.1f\n", NUM_PE * MACS_PER_PE * ENERGY_REG_PER_MAC,
+               energy.reg_accesses - energy.macs, energy.macs, energy_reg_total());
+        printf("GLB_STATS,%d,%d,%llu,%llu,%llu,%llu\n", glb.part[DRAM_IFM].lines, glb.part[DRAM_WEIGHT].lines,
+               glb.part[DRAM_IFM].hits, glb.part[DRAM_IFM].misses,
+               glb.part[DRAM_WEIGHT].hits, glb.part[DRAM_WEIGHT].misses);
+    }
+}
+
+void cleanup() {
+    if (ifm_map.base) tensor_unmap(&ifm_map);
+    else free(ifm_dram);
+    if (weight_map.base) tensor_unmap(&weight_map);
+    else free(weight_dram);
+    free(ofm_dram);
+    op_dump_free(&sim_op_dump);
+    sim_port_free(&dram_port);
+    free(dma_store_pending);
+    dma_store_pending = 0;
+    dma_store_n = dma_store_cap = 0;
+    dram_model_free();
+    sram_free(&ifm_sram);
+    sram_free(&weight_sram);
+    sram_free(&linebuf_sram);
+    glb_free();
+    pe_util_free();
+}
+
+#endif // SIM_CORE_H
@@ -0,0 +1,225 @@
+// LÕI THỜI GIAN DÙNG CHUNG CHO CÁC DATAFLOW: MÔ HÌNH ĐẶT CHỖ TÀI NGUYÊN (RESOURCE RESERVATION)
+//
+// Không có hàng đợi sự kiện: mỗi yêu cầu được xếp lịch ngay khi phát, theo thứ tự chương trình.
+// Thời điểm bắt đầu = max(unit rảnh, dữ liệu phụ thuộc sẵn sàng); unit và bank buffer ghi lại
+// thời điểm xong (free_at, ready_at, read_end) để yêu cầu sau dùng làm phụ thuộc.
+//
+// Thành phần:
+//   - sim_unit   : tài nguyên phục vụ tuần tự theo thứ tự yêu cầu (DMA engine, mảng PE).
+//                  Yêu cầu bắt đầu khi unit rảnh VÀ dữ liệu phụ thuộc sẵn sàng.
+//   - sim_buffer : buffer on-chip gồm 1 hoặc 2 bank (ping-pong). DMA ghi vào bank kế tiếp
+//                  khi không còn lệnh compute nào đang đọc bank đó; mảng PE đọc bank mới nhất.
+//   - sim_port   : cổng DRAM dùng chung cho nhiều hàng đợi DMA. Bộ phân xử cấp cổng theo thứ tự
+//                  thời điểm sẵn sàng (FCFS), mỗi lần cấp giữ cổng trọn 1 giao dịch (không chen ngang).
+//                  Yêu cầu phát sau nhưng sẵn sàng sớm hơn được lấp vào khoảng trống của cổng.
+//
+// Controller (dataflow) chỉ phát yêu cầu theo thứ tự chương trình. Phần dữ liệu (functional)
+// vẫn được tính ngay, lõi chỉ lo phần thời gian. Vì lịch được đặt lúc phát, yêu cầu phát sau không
+// thể chen lên trước yêu cầu phát trước trên cùng 1 unit (chỉ cổng DRAM có lấp khoảng trống).
+//
+// Chế độ:
+//   - SIM_OVERLAP=0 (mặc định): tuần tự, mỗi yêu cầu chờ yêu cầu trước xong -> total = DMA + compute
+//   - SIM_OVERLAP=1           : buffer 2 bank, DMA / compute chạy chồng lấp
+#ifndef SIM_TIMING_H
+#define SIM_TIMING_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef unsigned long long sim_time;
+
+#define SIM_MAX_BANKS 2
+
+typedef struct {
+    const char* name;
+    sim_time free_at;       // Thời điểm unit rảnh
+    sim_time busy;          // Tổng chu kỳ làm việc
+    sim_time wait;          // Chu kỳ đứng chờ (dữ liệu / bank) giữa 2 yêu cầu
+    sim_time first_start;   // Thời điểm bắt đầu yêu cầu đầu tiên
+    sim_time contention;    // Chu kỳ chờ cổng DRAM dùng chung (kênh DMA)
+    unsigned long long ops;
+} sim_unit;
+
+typedef struct {
+    const char* name;
+    int nbanks;
+    int cur;                            // Bank chứa dữ liệu mới nhất
+    int next;                           // Bank DMA sẽ ghi tiếp theo
+    sim_time ready_at[SIM_MAX_BANKS];   // DMA ghi xong
+    sim_time read_end[SIM_MAX_BANKS];   // Lệnh compute cuối cùng đọc bank này xong
+} sim_buffer;
+
+typedef struct {
+    sim_time start, end;
+} sim_interval;
+
+typedef struct {
+    const char* name;
+    sim_interval* busy;     // Các khoảng cổng đã được cấp, sắp theo thời gian, không chồng nhau
+    int n, cap;
+    sim_time busy_cycles;
+    unsigned long long grants;
+} sim_port;
+
+// --- TRẠNG THÁI TOÀN CỤC ---
+static int sim_overlap = 0;
+static sim_time sim_last_end = 0;   // Thời điểm xong muộn nhất của mọi yêu cầu đã phát
+
+// --- THÀNH PHẦN ---
+static inline void sim_unit_init(sim_unit* u, const char* name) {
+    memset(u, 0, sizeof(*u));
+    u->name = name;
+}
+
+static inline void sim_buffer_init(sim_buffer* b, const char* name) {
+    memset(b, 0, sizeof(*b));
+    b->name = name;
+    b->nbanks = sim_overlap ? 2 : 1;
+}
+
+// Chọn thời điểm bắt đầu: unit rảnh + phụ thuộc xong (+ mọi yêu cầu trước nếu tuần tự)
+static inline sim_time sim_start_time(sim_unit* u, sim_time deps) {
+    sim_time start = (u->free_at > deps) ? u->free_at : deps;
+    if (!sim_overlap && sim_last_end > start) start = sim_last_end;
+    if (u->ops > 0) u->wait += start - u->free_at;
+    else u->first_start = start;
+    return start;
+}
+
+static inline sim_time sim_issue(sim_unit* u, sim_time start, sim_time cycles) {
+    sim_time end = start + cycles;
+    u->free_at = end;
+    u->busy += cycles;
+    u->ops++;
+    if (end > sim_last_end) sim_last_end = end;
+    return end;
+}
+
+// --- CỔNG DRAM DÙNG CHUNG ---
+static inline void sim_port_init(sim_port* p, const char* name) {
+    free(p->busy);
+    memset(p, 0, sizeof(*p));
+    p->name = name;
+}
+
+// Thời điểm sớm nhất >= ready mà cổng rảnh liên tục cycles chu kỳ
+static inline sim_time sim_port_find(const sim_port* p, sim_time ready, sim_time cycles) {
+    sim_time t = ready;
+    for (int i = 0; i < p->n; i++) {
+        if (p->busy[i].end <= t) continue;
+        if (p->busy[i].start >= t + cycles) break;
+        t = p->busy[i].end;
+    }
+    return t;
+}
+
+static inline void sim_port_reserve(sim_port* p, sim_time start, sim_time cycles) {
+    p->busy_cycles += cycles;
+    p->grants++;
+    if (cycles == 0) return;
+    sim_time end = start + cycles;
+    int i = p->n;
+    while (i > 0 && p->busy[i - 1].start > start) i--;
+    // Nối vào khoảng kề trước / kề sau để danh sách luôn ngắn
+    if (i > 0 && p->busy[i - 1].end == start) {
+        p->busy[i - 1].end = end;
+        if (i < p->n && p->busy[i].start == end) {
+            p->busy[i - 1].end = p->busy[i].end;
+            memmove(p->busy + i, p->busy + i + 1, (p->n - i - 1) * sizeof(sim_interval));
+            p->n--;
+        }
+        return;
+    }
+    if (i < p->n && p->busy[i].start == end) {
+        p->busy[i].start = start;
+        return;
+    }
+    if (p->n == p->cap) {
+        p->cap = p->cap ? p->cap * 2 : 64;
+        p->busy = (sim_interval*)realloc(p->busy, p->cap * sizeof(sim_interval));
+    }
+    memmove(p->busy + i + 1, p->busy + i, (p->n - i) * sizeof(sim_interval));
+    p->busy[i].start = start;
+    p->busy[i].end = end;
+    p->n++;
+}
+
+// Bỏ các khoảng kết thúc trước t (không yêu cầu nào còn có thể bắt đầu trước t)
+static inline void sim_port_prune(sim_port* p, sim_time t) {
+    int k = 0;
+    while (k < p->n && p->busy[k].end <= t) k++;
+    if (k == 0) return;
+    memmove(p->busy, p->busy + k, (p->n - k) * sizeof(sim_interval));
+    p->n -= k;
+}
+
+static inline void sim_port_free(sim_port* p) {
+    free(p->busy);
+    p->busy = 0;
+    p->n = p->cap = 0;
+}
+
+// 1 giao dịch DMA bắt đầu sau deps (port != NULL: chờ bộ phân xử cấp cổng DRAM dùng chung)
+static inline sim_time sim_dma_issue(sim_unit* dma, sim_port* port, sim_time cycles, sim_time deps) {
+    sim_time start = sim_start_time(dma, deps);
+    if (port) {
+        sim_time granted = sim_port_find(port, start, cycles);
+        dma->contention += granted - start;
+        if (dma->ops > 0) dma->wait += granted - start;
+        else dma->first_start = granted;
+        start = granted;
+        sim_port_reserve(port, start, cycles);
+    }
+    return sim_issue(dma, start, cycles);
+}
+
+// DMA ghi vào a (và b nếu khác NULL, vd IFM + Weight chung 1 lần truyền)
+// port != NULL: giao dịch phải được bộ phân xử cấp cổng DRAM dùng chung trước khi chạy
+static inline sim_time sim_dma_port(sim_unit* dma, sim_port* port, sim_time cycles, sim_buffer* a, sim_buffer* b) {
+    sim_time deps = 0;
+    if (a && a->read_end[a->next] > deps) deps = a->read_end[a->next];
+    if (b && b->read_end[b->next] > deps) deps = b->read_end[b->next];
+    sim_time end = sim_dma_issue(dma, port, cycles, deps);
+
+    sim_buffer* bufs[2] = { a, b };
+    for (int i = 0; i < 2; i++) {
+        sim_buffer* buf = bufs[i];
+        if (!buf) continue;
+        int bank = buf->next;
+        buf->ready_at[bank] = end;
+        buf->cur = bank;
+        buf->next = (bank + 1) % buf->nbanks;
+    }
+    return end;
+}
+
+// DMA ghi ra DRAM (psum / OFM): bắt đầu sau khi dữ liệu sẵn sàng (after), không chiếm bank buffer nào
+static inline sim_time sim_dma_store(sim_unit* dma, sim_port* port, sim_time cycles, sim_time after) {
+    return sim_dma_issue(dma, port, cycles, after);
+}
+
+// Mảng PE đọc bank mới nhất của a, b (NULL = không phụ thuộc buffer)
+static inline sim_time sim_compute(sim_unit* pe, sim_time cycles, sim_buffer* a, sim_buffer* b) {
+    sim_time deps = 0;
+    if (a && a->ready_at[a->cur] > deps) deps = a->ready_at[a->cur];
+    if (b && b->ready_at[b->cur] > deps) deps = b->ready_at[b->cur];
+    sim_time start = sim_start_time(pe, deps);
+    sim_time end = sim_issue(pe, start, cycles);
+    if (a && end > a->read_end[a->cur]) a->read_end[a->cur] = end;
+    if (b && end > b->read_end[b->cur]) b->read_end[b->cur] = end;
+    return end;
+}
+
+// Thời điểm kết thúc mô phỏng: yêu cầu xong muộn nhất
+static inline sim_time sim_end_time() {
+    return sim_last_end;
+}
+
+static inline void sim_timing_init() {
+    const char* env = getenv("SIM_OVERLAP");
+    sim_overlap = (env && atoi(env) != 0);
+    sim_last_end = 0;
+}
+
+#endif // SIM_TIMING_H
@@ -0,0 +1,131 @@
+// MÔ HÌNH SRAM ON-CHIP CHIA BANK (BANK CONFLICT)
+//
+// Mô hình cũ: buffer_ifm / buffer_weight là mảng phẳng, đọc/ghi không tốn gì, mỗi lượt PE
+// tốn PE_COMPUTE_CYCLES bất kể bao nhiêu PE cùng đọc 1 lúc.
+//
+// Mô hình này (bật bằng SIM_SRAM=1), mỗi buffer là 1 SRAM riêng gồm:
+//   - SRAM_BANKS      : số bank                                  (mặc định 16)
+//   - SRAM_PORT_BYTES : độ rộng cổng (1 word)                    (mặc định 8)
+//   - SRAM_RPORTS     : số cổng đọc / bank                       (mặc định 1)
+//   - SRAM_WPORTS     : số cổng ghi / bank                       (mặc định 1)
+//   - SRAM_INTERLEAVE : cách chia địa chỉ vào bank               (mặc định 0)
+//       0 = word xen kẽ  : bank = word % banks
+//       1 = theo khối    : bank = (word / words_per_bank) % banks (mỗi bank giữ 1 đoạn liền)
+//       2 = XOR          : bank = (word ^ (word / banks)) % banks
+//
+// Mỗi lượt truy cập (1 lượt tính của mảng PE, hoặc 1 giao dịch DMA ghi buffer):
+//   - sram_touch ghi lại các word bị đọc/ghi (cùng 1 word đọc nhiều lần = broadcast, tính 1)
+//   - sram_flush trả về số chu kỳ = max theo bank của ceil(số word / số cổng)
+// Lượt tính kéo dài max(chu kỳ compute, chu kỳ SRAM) -> phần dư là chu kỳ stall do bank conflict.
+#ifndef SRAM_MODEL_H
+#define SRAM_MODEL_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SRAM_MAX_BANKS 256
+
+typedef struct {
+    int enabled;
+    int banks, port_bytes, rports, wports, interleave;
+    int bank_bytes;         // Dung lượng 1 bank (dùng cho chia theo khối)
+} sram_config;
+
+typedef struct {
+    const char* name;
+    unsigned int* stamp;            // stamp[word] = lượt truy cập gần nhất chạm word này
+    int cap;                        // Số word của mảng stamp
+    unsigned int step;
+    int count[SRAM_MAX_BANKS];      // Số word khác nhau / bank trong lượt hiện tại
+    unsigned long long read_words, write_words;
+    unsigned long long read_cycles, write_cycles;
+} sram_model;
+
+static sram_config sram_cfg;
+
+static inline int sram_env(const char* name, int def) {
+    const char* env = getenv(name);
+    return (env && atoi(env) > 0) ? atoi(env) : def;
+}
+
+// buffer_bytes: dung lượng buffer danh nghĩa (BUFFER_SIZE_BYTES), dùng để chia khối
+static inline void sram_config_init(int buffer_bytes) {
+    const char* env = getenv("SIM_SRAM");
+    sram_cfg.enabled = (env && atoi(env) != 0);
+    sram_cfg.banks = sram_env("SRAM_BANKS", 16);
+    if (sram_cfg.banks > SRAM_MAX_BANKS) sram_cfg.banks = SRAM_MAX_BANKS;
+    sram_cfg.port_bytes = sram_env("SRAM_PORT_BYTES", 8);
+    sram_cfg.rports = sram_env("SRAM_RPORTS", 1);
+    sram_cfg.wports = sram_env("SRAM_WPORTS", 1);
+    env = getenv("SRAM_INTERLEAVE");
+    sram_cfg.interleave = env ? atoi(env) : 0;
+    int words = (buffer_bytes + sram_cfg.port_bytes - 1) / sram_cfg.port_bytes;
+    int words_per_bank = (words + sram_cfg.banks - 1) / sram_cfg.banks;
+    sram_cfg.bank_bytes = (words_per_bank > 0 ? words_per_bank : 1) * sram_cfg.port_bytes;
+}
+
+static inline void sram_init(sram_model* s, const char* name) {
+    free(s->stamp);
+    memset(s, 0, sizeof(*s));
+    s->name = name;
+}
+
+static inline int sram_bank_of(long long word) {
+    int nb = sram_cfg.banks;
+    switch (sram_cfg.interleave) {
+    case 1:  return (int)((word / (sram_cfg.bank_bytes / sram_cfg.port_bytes)) % nb);
+    case 2:  return (int)((word ^ (word / nb)) % nb);
+    default: return (int)(word % nb);
+    }
+}
+
+// Ghi lại truy cập bytes byte bắt đầu từ offset (tính theo byte trong buffer)
+static inline void sram_touch(sram_model* s, long long offset, long long bytes) {
+    if (!sram_cfg.enabled || bytes <= 0) return;
+    long long first = offset / sram_cfg.port_bytes;
+    long long last = (offset + bytes - 1) / sram_cfg.port_bytes;
+    if (last >= s->cap) {
+        int cap = s->cap ? s->cap : 256;
+        while (cap <= last) cap *= 2;
+        s->stamp = (unsigned int*)realloc(s->stamp, cap * sizeof(unsigned int));
+        memset(s->stamp + s->cap, 0, (cap - s->cap) * sizeof(unsigned int));
+        s->cap = cap;
+    }
+    for (long long w = first; w <= last; w++) {
+        if (s->stamp[w] == s->step + 1) continue;   // Word đã có trong lượt này (broadcast)
+        s->stamp[w] = s->step + 1;
+        s->count[sram_bank_of(w)]++;
+    }
+}
+
+// Kết thúc 1 lượt truy cập: trả về số chu kỳ cần để phục vụ (0 nếu không có truy cập)
+static inline unsigned long long sram_flush(sram_model* s, int is_write) {
+    if (!sram_cfg.enabled || !s) return 0;
+    int ports = is_write ? sram_cfg.wports : sram_cfg.rports;
+    unsigned long long cycles = 0, words = 0;
+    for (int b = 0; b < sram_cfg.banks; b++) {
+        unsigned long long c = (s->count[b] + ports - 1) / ports;
+        if (c > cycles) cycles = c;
+        words += s->count[b];
+        s->count[b] = 0;
+    }
+    if (words == 0) return 0;
+    s->step++;
+    if (is_write) {
+        s->write_words += words;
+        s->write_cycles += cycles;
+    } else {
+        s->read_words += words;
+        s->read_cycles += cycles;
+    }
+    return cycles;
+}
+
+static inline void sram_free(sram_model* s) {
+    free(s->stamp);
+    s->stamp = 0;
+    s->cap = 0;
+}
+
+#endif // SRAM_MODEL_H
@@ -0,0 +1,443 @@
+// FILE TENSOR NHỊ PHÂN (.bin)
+//
+// params/ifm.txt là text thập phân, 1 byte / dòng: mỗi lần chạy phải fgets + atoi hàng trăm nghìn dòng
+// trước khi mô phỏng, chiếm phần lớn thời gian "seconds" perf đo được. File .bin chứa dữ liệu thô
+// (little-endian) sau 1 header 64 byte mô tả tensor:
+//   magic "TNSR", version, dtype (TENSOR_I8 / TENSOR_I32), layout, ndim, dims[4],
+//   tham số lượng tử (scale, zero_point) và offset của dữ liệu
+// Layout:
+//   - TENSOR_NHWC : IFM [H][W][C], OFM [H][W][F] (như text)
+//   - TENSOR_OHWI : Weight [F][KH][KW][C] (thứ tự của weights.txt / TFLite)
+//   - TENSOR_HWIO : Weight [KH][KW][C][F] (layout weight_dram, nạp thẳng không cần sắp lại)
+// Tạo file .bin từ text bằng config/tensor_convert.cpp.
+//
+// tensor_map: ánh xạ file chỉ đọc (mmap) và dùng thẳng dữ liệu, không malloc, không chép: khởi động gần
+// như 0 với tensor hàng trăm MB, các tiến trình quét song song dùng chung 1 bản trong page cache.
+// Gợi ý kernel: MADV_WILLNEED (readahead), MADV_HUGEPAGE (nếu kernel hỗ trợ THP cho file).
+// Không có mmap (không phải POSIX) -> tensor_map trả về NULL, người gọi dùng tensor_load.
+//
+// tensor_read_text: file text cũ (1 số / dòng, từ temp/gen_tf_layer_02_0b.py, code_python.py) đọc 1 lần
+// fread cả file rồi quét trên buffer (không fgets + atoi từng dòng): mặt nạ khoảng trắng 64 byte / lần
+// cho vị trí các số, mỗi số đọc bằng SWAR 8 byte. Số cách nhau bởi khoảng trắng bất kỳ (\n, \r\n,
+// space, tab); int8: giá trị > 0x7F là số âm 8-bit viết không dấu.
+//
+// File NumPy .npy (np.save / np.load của các script Python, không cần đổi qua text):
+//   - tensor_load_npy: số nguyên C-order (int8 / uint8 / int16 / int32 / int64, little-endian), tối đa
+//     4 chiều, đổi sang TENSOR_I8 (giữ 8 bit thấp như text) hoặc TENSOR_I32. Shape giữ nguyên thứ tự
+//     của Python: IFM (H, W, C) / (1, H, W, C), Weight (KH, KW, C, F) = HWCF hoặc (F, KH, KW, C)
+//   - tensor_save_npy: ghi .npy v1.0 ('|i1' hoặc '<i4'), np.load đọc thẳng được
+#ifndef TENSOR_IO_H
+#define TENSOR_IO_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define TENSOR_HAVE_MMAP 1
+#endif
+
+#define TENSOR_MAGIC "TNSR"
+#define TENSOR_VERSION 1
+#define TENSOR_HEADER_BYTES 64
+
+#define TENSOR_I8 1
+#define TENSOR_I32 4
+
+#define TENSOR_NHWC 0
+#define TENSOR_OHWI 1
+#define TENSOR_HWIO 2
+
+typedef struct {
+    char magic[4];
+    uint16_t version;
+    uint8_t dtype;              // Số byte / phần tử: TENSOR_I8 hoặc TENSOR_I32
+    uint8_t layout;             // TENSOR_NHWC / TENSOR_OHWI / TENSOR_HWIO
+    uint32_t ndim;
+    uint32_t dims[4];           // Các chiều theo layout, chiều không dùng = 1
+    float scale;                // Lượng tử: real = scale * (q - zero_point), 0 nếu không có
+    int32_t zero_point;
+    uint32_t data_offset;       // Byte đầu của dữ liệu (= TENSOR_HEADER_BYTES)
+    uint8_t reserved[24];
+} tensor_header;
+
+static_assert(sizeof(tensor_header) == TENSOR_HEADER_BYTES, "tensor_header must be 64 bytes");
+
+static inline tensor_header tensor_header_make(int dtype, int layout, int ndim, const int* dims) {
+    tensor_header h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, TENSOR_MAGIC, 4);
+    h.version = TENSOR_VERSION;
+    h.dtype = (uint8_t)dtype;
+    h.layout = (uint8_t)layout;
+    h.ndim = (uint32_t)ndim;
+    for (int i = 0; i < 4; i++) h.dims[i] = (i < ndim) ? (uint32_t)dims[i] : 1;
+    h.data_offset = TENSOR_HEADER_BYTES;
+    return h;
+}
+
+static inline long long tensor_elems(const tensor_header* h) {
+    long long n = 1;
+    for (int i = 0; i < 4; i++) n *= h->dims[i];
+    return n;
+}
+
+// Ghi header + dữ liệu. Trả về 0 nếu thành công, -1 nếu lỗi
+static inline int tensor_save(const char* path, const tensor_header* h, const void* data) {
+    FILE* f = fopen(path, "wb");
+    if (!f) return -1;
+    size_t bytes = (size_t)tensor_elems(h) * h->dtype;
+    int ok = fwrite(h, sizeof(*h), 1, f) == 1 && fwrite(data, 1, bytes, f) == bytes;
+    fclose(f);
+    return ok ? 0 : -1;
+}
+
+// Đọc header (kiểm tra magic / version / dtype). Trả về FILE* đã trỏ tới dữ liệu, NULL nếu không có file
+// hoặc không phải file tensor
+static inline FILE* tensor_open(const char* path, tensor_header* h) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return NULL;
+    if (fread(h, sizeof(*h), 1, f) != 1 || memcmp(h->magic, TENSOR_MAGIC, 4) != 0 ||
+        h->version != TENSOR_VERSION || (h->dtype != TENSOR_I8 && h->dtype != TENSOR_I32) ||
+        fseek(f, h->data_offset, SEEK_SET) != 0) {
+        printf("Error: %s is not a tensor file\n", path);
+        fclose(f);
+        return NULL;
+    }
+    return f;
+}
+
+// Đọc cả file vào bộ nhớ mới cấp phát (free bởi người gọi). NULL nếu lỗi
+static inline void* tensor_load(const char* path, tensor_header* h) {
+    FILE* f = tensor_open(path, h);
+    if (!f) return NULL;
+    size_t bytes = (size_t)tensor_elems(h) * h->dtype;
+    void* data = malloc(bytes ? bytes : 1);
+    if (data && fread(data, 1, bytes, f) != bytes) {
+        printf("Error: %s is truncated\n", path);
+        free(data);
+        data = NULL;
+    }
+    fclose(f);
+    return data;
+}
+
+// dtype / layout / các chiều có đúng không (không in gì). dims[i] < 0: không kiểm tra chiều i
+static inline int tensor_match(const tensor_header* h, int dtype, int layout, int ndim, const int* dims) {
+    int ok = h->dtype == dtype && h->layout == layout && (int)h->ndim == ndim;
+    for (int i = 0; ok && i < ndim; i++) {
+        if (dims[i] >= 0 && (int)h->dims[i] != dims[i]) ok = 0;
+    }
+    return ok;
+}
+
+// Như tensor_match, in lỗi nếu không khớp
+static inline int tensor_check(const char* path, const tensor_header* h, int dtype, int layout,
+                               int ndim, const int* dims) {
+    int ok = tensor_match(h, dtype, layout, ndim, dims);
+    if (!ok) {
+        printf("Error: %s has dtype %d, layout %d, shape [%u, %u, %u, %u] - not what this layer needs\n", path,
+               h->dtype, h->layout, h->dims[0], h->dims[1], h->dims[2], h->dims[3]);
+    }
+    return ok;
+}
+
+// SWAR: 8 byte từ p (little-endian) -> số chữ số đầu tiên (len, 0..8) và giá trị của chúng.
+// Không rẽ nhánh theo số chữ số: tìm byte không phải chữ số bằng mặt nạ, dời các chữ số lên đầu word
+// (các byte đầu thành 0) rồi gộp 8 chữ số -> 4 cặp -> 2 nhóm 4 -> 1 số bằng 3 phép nhân
+static inline uint32_t tensor_digits8(const char* p, int* len) {
+    uint64_t w;
+    memcpy(&w, p, 8);
+    uint64_t t = w ^ 0x3030303030303030ULL;        // '0'..'9' -> 0..9
+    uint64_t nd = (((t & 0x7F7F7F7F7F7F7F7FULL) + 0x7676767676767676ULL) | t) & 0x8080808080808080ULL;
+    int n = nd ? __builtin_ctzll(nd) >> 3 : 8;
+    *len = n;
+    if (n == 0) return 0;
+    t = (t << ((8 - n) * 8)) & 0x0F0F0F0F0F0F0F0FULL;
+    t = (t * 2561) >> 8;
+    t = ((t & 0x00FF00FF00FF00FFULL) * 6553601) >> 16;
+    return (uint32_t)(((t & 0x0000FFFF0000FFFFULL) * 42949672960001ULL) >> 32);
+}
+
+// Bit i = 1 nếu p[i] là khoảng trắng / CR / LF / '\0' (byte <= ' '), 64 byte / lần (SSE2 nếu có)
+static inline uint64_t tensor_space_mask(const char* p) {
+#ifdef __SSE2__
+    const __m128i limit = _mm_set1_epi8(' ' + 1);
+    uint64_t m = 0;
+    for (int k = 0; k < 4; k++) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(p + 16 * k));
+        m |= (uint64_t)(uint16_t)_mm_movemask_epi8(_mm_cmplt_epi8(v, limit)) << (16 * k);
+    }
+    return m;
+#else
+    uint64_t m = 0;
+    for (int k = 0; k < 64; k++) m |= (uint64_t)((unsigned char)p[k] <= ' ') << k;
+    return m;
+#endif
+}
+
+// Quét tối đa n số thập phân từ buf (size byte, sau đó đọc được ít nhất 64 + 8 byte) vào out.
+// Trả về số phần tử đã đọc. Mỗi khối 64 byte: tìm mọi vị trí bắt đầu số (byte đầu sau khoảng trắng)
+// bằng mặt nạ bit, rồi đọc từng số độc lập bằng tensor_digits8 -> không có chuỗi phụ thuộc giữa các số
+static inline long long tensor_parse_text(const char* buf, long long size, int dtype, long long n, void* out) {
+    int8_t* out8 = (int8_t*)out;
+    int32_t* out32 = (int32_t*)out;
+    long long i = 0;
+    uint64_t prev = 1;      // Trước byte đầu coi như khoảng trắng
+    for (long long off = 0; off < size && i < n; off += 64) {
+        uint64_t space = tensor_space_mask(buf + off);
+        uint64_t starts = ~space & ((space << 1) | prev);
+        prev = space >> 63;
+        if (size - off < 64) starts &= (1ULL << (size - off)) - 1;     // Không đọc quá size (buf là 1 đoạn)
+        while (starts && i < n) {
+            const char* p = buf + off + __builtin_ctzll(starts);
+            starts &= starts - 1;
+            int neg = (*p == '-');
+            p += neg;
+            int len;
+            int64_t v = tensor_digits8(p, &len);
+            // Hơn 8 chữ số (chỉ có ở int32): tiếp tục từng chữ số
+            unsigned d;
+            for (p += len; len == 8 && (d = (unsigned char)(*p - '0')) < 10; p++) v = v * 10 + d;
+            v = neg ? -v : v;
+            if (dtype == TENSOR_I8) out8[i] = (int8_t)((v > 0x7F) ? v - 0x100 : v);
+            else out32[i] = (int32_t)v;
+            i++;
+        }
+    }
+    return i;
+}
+
+// Đọc file text vào out (n phần tử dtype, phần thiếu giữ nguyên). Trả về số phần tử đã đọc, -1 nếu lỗi
+static inline long long tensor_read_text(const char* path, int dtype, long long n, void* out) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return -1;
+    long long size = -1;
+    if (fseek(f, 0, SEEK_END) == 0) size = ftell(f);
+    char* buf = (size >= 0) ? (char*)malloc((size_t)size + 64 + 8) : NULL;
+    if (!buf || fseek(f, 0, SEEK_SET) != 0 || fread(buf, 1, (size_t)size, f) != (size_t)size) {
+        free(buf);
+        fclose(f);
+        return -1;
+    }
+    fclose(f);
+    memset(buf + size, 0, 64 + 8);
+    long long got = tensor_parse_text(buf, size, dtype, n, out);
+    free(buf);
+    return got;
+}
+
+// Vùng ánh xạ của tensor_map (base / len để tensor_unmap)
+typedef struct {
+    void* base;
+    size_t len;
+} tensor_mapping;
+
+// Ánh xạ file chỉ đọc. Trả về con trỏ tới dữ liệu (sau header), NULL nếu không có file, không phải
+// file tensor hoặc không mmap được
+static inline const void* tensor_map(const char* path, tensor_header* h, tensor_mapping* m) {
+    m->base = NULL;
+    m->len = 0;
+#ifdef TENSOR_HAVE_MMAP
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return NULL;
+    struct stat st;
+    void* base = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && st.st_size >= TENSOR_HEADER_BYTES) {
+        base = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    close(fd);      // Vùng ánh xạ vẫn giữ file
+    if (base == MAP_FAILED) return NULL;
+    memcpy(h, base, sizeof(*h));
+    size_t bytes = (size_t)tensor_elems(h) * h->dtype;
+    if (memcmp(h->magic, TENSOR_MAGIC, 4) != 0 || h->version != TENSOR_VERSION ||
+        (h->dtype != TENSOR_I8 && h->dtype != TENSOR_I32) || h->data_offset + bytes > (size_t)st.st_size) {
+        munmap(base, (size_t)st.st_size);
+        return NULL;
+    }
+#ifdef MADV_HUGEPAGE
+    madvise(base, (size_t)st.st_size, MADV_HUGEPAGE);
+#endif
+    madvise(base, (size_t)st.st_size, MADV_WILLNEED);
+    m->base = base;
+    m->len = (size_t)st.st_size;
+    return (const char*)base + h->data_offset;
+#else
+    (void)path;
+    (void)h;
+    return NULL;
+#endif
+}
+
+static inline void tensor_unmap(tensor_mapping* m) {
+#ifdef TENSOR_HAVE_MMAP
+    if (m->base) munmap(m->base, m->len);
+#endif
+    m->base = NULL;
+    m->len = 0;
+}
+
+// NUMPY .npy: "\x93NUMPY", version (major, minor), độ dài header (2 byte ở v1, 4 byte ở v2 / v3),
+// header là dict Python ASCII {'descr': '<i4', 'fortran_order': False, 'shape': (112, 112, 32), },
+// đệm space + '\n' để dữ liệu bắt đầu ở bội số 64 byte
+#define TENSOR_NPY_MAGIC "\x93NUMPY"
+
+// Đuôi file là .npy
+static inline int tensor_is_npy(const char* path) {
+    size_t len = strlen(path);
+    return len >= 4 && strcmp(path + len - 4, ".npy") == 0;
+}
+
+// Giá trị chuỗi sau key (vd 'descr') trong header, NULL nếu không có
+static inline const char* tensor_npy_field(const char* header, const char* key) {
+    const char* p = strstr(header, key);
+    if (!p) return NULL;
+    p = strchr(p + strlen(key), ':');
+    if (!p) return NULL;
+    p++;
+    while (*p == ' ') p++;
+    return p;
+}
+
+// Đọc file .npy số nguyên, đổi sang dtype (TENSOR_I8 / TENSOR_I32; 0: giữ 1 byte -> I8, còn lại -> I32).
+// h nhận dtype, ndim, dims theo shape (layout TENSOR_NHWC, chiều 1 ở đầu bị bỏ nếu shape > 4 chiều).
+// Trả về dữ liệu mới cấp phát (free bởi người gọi), NULL nếu không có file hoặc file không đọc được
+static inline void* tensor_load_npy(const char* path, tensor_header* h, int dtype) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return NULL;
+    unsigned char pre[12];
+    char* header = NULL;
+    void* data = NULL;
+    unsigned char* raw = NULL;
+    long long n = 1;
+    int esize = 0, is_signed = 1, ndim = 0;
+    long long shape[8];
+    const char* p;
+    size_t hlen = 0;
+    if (fread(pre, 1, 10, f) != 10 || memcmp(pre, TENSOR_NPY_MAGIC, 6) != 0) goto bad;
+    if (pre[6] == 1) {
+        hlen = pre[8] | (pre[9] << 8);
+    } else {
+        if (fread(pre + 10, 1, 2, f) != 2) goto bad;
+        hlen = pre[8] | (pre[9] << 8) | ((size_t)pre[10] << 16) | ((size_t)pre[11] << 24);
+    }
+    header = (char*)malloc(hlen + 1);
+    if (!header || fread(header, 1, hlen, f) != hlen) goto bad;
+    header[hlen] = 0;
+
+    // descr: '|i1' '<i1' '|u1' '<i2' '<i4' '<i8' (byte order '>' không hỗ trợ)
+    p = tensor_npy_field(header, "'descr'");
+    if (!p || (*p != '\'' && *p != '"')) goto bad;
+    p++;
+    if (*p == '<' || *p == '|' || *p == '=') p++;
+    if (*p == 'u') is_signed = 0;
+    else if (*p != 'i') goto bad;
+    esize = p[1] - '0';
+    if ((esize != 1 && esize != 2 && esize != 4 && esize != 8) || (!is_signed && esize != 1)) goto bad;
+
+    p = tensor_npy_field(header, "'fortran_order'");
+    if (!p || strncmp(p, "False", 5) != 0) goto bad;
+
+    p = tensor_npy_field(header, "'shape'");
+    if (!p || *p != '(') goto bad;
+    p++;
+    while (*p && *p != ')') {
+        char* end;
+        long long v = strtoll(p, &end, 10);
+        if (end == p) {
+            p++;            // ',' / ' '
+            continue;
+        }
+        if (ndim == 8 || v < 0) goto bad;
+        shape[ndim++] = v;
+        p = end;
+    }
+    while (ndim > 4 && shape[0] == 1) {
+        memmove(shape, shape + 1, (ndim - 1) * sizeof(shape[0]));
+        ndim--;
+    }
+    if (ndim > 4) goto bad;
+
+    if (dtype == 0) dtype = (esize == 1) ? TENSOR_I8 : TENSOR_I32;
+    {
+        int dims[4] = { 1, 1, 1, 1 };
+        for (int i = 0; i < ndim; i++) dims[i] = (int)shape[i];
+        *h = tensor_header_make(dtype, TENSOR_NHWC, ndim, dims);
+    }
+    n = tensor_elems(h);
+    data = malloc(n > 0 ? (size_t)n * dtype : 1);
+    if (!data) goto bad;
+    if (esize == dtype && is_signed) {
+        if (fread(data, (size_t)esize, (size_t)n, f) != (size_t)n) goto bad;
+    } else {
+        // Đổi kiểu: đọc thô rồi chép từng phần tử (int8 giữ 8 bit thấp, uint8 -> int32 không dấu)
+        raw = (unsigned char*)malloc(n > 0 ? (size_t)n * esize : 1);
+        if (!raw || fread(raw, (size_t)esize, (size_t)n, f) != (size_t)n) goto bad;
+        for (long long i = 0; i < n; i++) {
+            int32_t v;
+            if (esize == 1) v = is_signed ? (int8_t)raw[i] : raw[i];
+            else if (esize == 2) v = (int16_t)(raw[2 * i] | (raw[2 * i + 1] << 8));
+            else memcpy(&v, raw + esize * i, 4);       // <i8: 32 bit thấp (little-endian)
+            if (dtype == TENSOR_I8) ((int8_t*)data)[i] = (int8_t)v;
+            else ((int32_t*)data)[i] = v;
+        }
+        free(raw);
+    }
+    free(header);
+    fclose(f);
+    return data;
+
+bad:
+    printf("Error: %s is not an integer C-order .npy file\n", path);
+    free(raw);
+    free(data);
+    free(header);
+    fclose(f);
+    return NULL;
+}
+
+// Ghi .npy v1.0: dtype TENSOR_I8 ('|i1') / TENSOR_I32 ('<i4'), shape = dims[0..ndim). 0 nếu thành công
+static inline int tensor_save_npy(const char* path, int dtype, int ndim, const int* dims, const void* data) {
+    char header[256];
+    int len = snprintf(header, sizeof(header), "{'descr': '%s', 'fortran_order': False, 'shape': (",
+                       (dtype == TENSOR_I8) ? "|i1" : "<i4");
+    long long n = 1;
+    for (int i = 0; i < ndim; i++) {
+        len += snprintf(header + len, sizeof(header) - len, (ndim == 1) ? "%d," : (i ? ", %d" : "%d"), dims[i]);
+        n *= dims[i];
+    }
+    len += snprintf(header + len, sizeof(header) - len, "), }");
+    // 10 byte đầu + header + '\n' chia hết cho 64
+    while ((10 + len + 1) % 64 != 0) header[len++] = ' ';
+    header[len++] = '\n';
+    unsigned char pre[10];
+    memcpy(pre, TENSOR_NPY_MAGIC, 6);
+    pre[6] = 1;
+    pre[7] = 0;
+    pre[8] = (unsigned char)(len & 0xFF);
+    pre[9] = (unsigned char)(len >> 8);
+    FILE* f = fopen(path, "wb");
+    if (!f) return -1;
+    int ok = fwrite(pre, 1, 10, f) == 10 && fwrite(header, 1, len, f) == (size_t)len &&
+             fwrite(data, (size_t)dtype, (size_t)n, f) == (size_t)n;
+    fclose(f);
+    return ok ? 0 : -1;
+}
+
+// SIM_OFM_FORMAT=txt (mặc định) / bin / npy / both (= txt + bin), ghép được (vd bin,npy) -> các file OFM cần ghi
+static inline void tensor_ofm_formats(int* txt, int* bin, int* npy) {
+    const char* env = getenv("SIM_OFM_FORMAT");
+    int both = env && strstr(env, "both") != NULL;
+    *bin = env && (both || strstr(env, "bin"));
+    *npy = env && strstr(env, "npy");
+    *txt = !env || both || strstr(env, "txt") || (!*bin && !*npy);
+}
+
+#endif // TENSOR_IO_H
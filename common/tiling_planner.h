@@ -0,0 +1,88 @@
+// BỘ LẬP KẾ HOẠCH TILING THEO DUNG LƯỢNG BUFFER (BUFFER_SIZE_BYTES)
+//
+// Trước đây PARALLEL_CHANNELS = NUM_PE * MACS_PER_PE / kernel_size, không nhìn tới BUFFER_SIZE_BYTES:
+// buffer nhỏ thì ghi tràn, buffer lớn thì không được tận dụng.
+//
+// Tile gồm 4 chiều:
+//   - tc : số channel / pass              (<= số channel mảng PE tính song song được)
+//   - th : số hàng output / nhóm          (dataflow không chia hàng thì = 1)
+//   - tw : số cột output / khối
+//   - tf : số filter có weight nằm trong buffer cùng lúc
+// Mỗi dataflow cung cấp hàm mô hình: với 1 tile, điền dung lượng cần trên buffer IFM / Weight và
+// số chu kỳ DMA / compute (mô hình giải tích, cùng công thức ceil(bytes / bus) với mô phỏng).
+// DMA gồm cả psum: đọc-sửa-ghi giữa các pass + ghi kết quả cuối (sim_psum_xfer_cycles, theo SIM_PSUM /
+// SIM_PSUM_BUF), nên tile giảm số pass hoặc giữ psum on-chip được tính đúng lợi ích.
+// Bộ lập kế hoạch duyệt mọi tile trong giới hạn, bỏ tile không vừa (mỗi buffer <= BUFFER_SIZE_BYTES)
+// và chọn tile có tổng chu kỳ mô hình (DMA + compute) nhỏ nhất; bằng nhau thì ít DMA hơn,
+// rồi tới tile lớn hơn. Không tile nào vừa -> báo lỗi, dataflow từ chối cấu hình.
+#ifndef TILING_PLANNER_H
+#define TILING_PLANNER_H
+
+#include <stdio.h>
+
+typedef struct {
+    int tc, th, tw, tf;
+    long long ifm_bytes;            // Dung lượng cần trên buffer IFM
+    long long weight_bytes;         // Dung lượng cần trên buffer Weight
+    unsigned long long dma;         // Chu kỳ DMA mô hình
+    unsigned long long compute;     // Chu kỳ compute mô hình
+} tile_plan;
+
+typedef void (*plan_model_fn)(tile_plan* t);
+
+static inline int plan_better(const tile_plan* a, const tile_plan* b) {
+    unsigned long long ta = a->dma + a->compute, tb = b->dma + b->compute;
+    if (ta != tb) return ta < tb;
+    return a->dma < b->dma;
+}
+
+// max: giới hạn trên của từng chiều (>= 1). capacity: dung lượng mỗi buffer (byte)
+// Trả về 0 và ghi tile tốt nhất vào best; -1 nếu không tile nào vừa (best->ifm_bytes / weight_bytes
+// khi đó là dung lượng nhỏ nhất cần có)
+static inline int plan_tiling(tile_plan* best, const tile_plan* max, long long capacity, plan_model_fn model) {
+    int found = 0;
+    long long min_need = -1;
+    tile_plan min_tile = *max;
+    // Duyệt từ lớn tới nhỏ để khi bằng nhau giữ tile lớn hơn
+    for (int tc = max->tc; tc >= 1; tc--)
+        for (int th = max->th; th >= 1; th--)
+            for (int tw = max->tw; tw >= 1; tw--)
+                for (int tf = max->tf; tf >= 1; tf--) {
+                    tile_plan t = { tc, th, tw, tf, 0, 0, 0, 0 };
+                    model(&t);
+                    long long need = (t.ifm_bytes > t.weight_bytes) ? t.ifm_bytes : t.weight_bytes;
+                    if (need > capacity) {
+                        if (min_need < 0 || need < min_need) {
+                            min_need = need;
+                            min_tile = t;
+                        }
+                        continue;
+                    }
+                    if (!found || plan_better(&t, best)) {
+                        *best = t;
+                        found = 1;
+                    }
+                }
+    if (!found) {
+        *best = min_tile;
+        return -1;
+    }
+    return 0;
+}
+
+// Gọi trong main: lập kế hoạch, báo lỗi nếu không vừa
+static inline int plan_or_reject(tile_plan* best, const tile_plan* max, long long capacity, plan_model_fn model) {
+    if (plan_tiling(best, max, capacity, model) == 0) return 0;
+    long long need = (best->ifm_bytes > best->weight_bytes) ? best->ifm_bytes : best->weight_bytes;
+    printf("Error: BUFFER_SIZE_BYTES = %lld is too small, smallest tile needs %lld bytes "
+           "(IFM %lld, Weight %lld)\n", capacity, need, best->ifm_bytes, best->weight_bytes);
+    return -1;
+}
+
+// PLAN_STATS,tc,th,tw,tf,byte IFM,byte Weight,DMA mô hình,compute mô hình
+static inline void plan_report(const tile_plan* t) {
+    printf("PLAN_STATS,%d,%d,%d,%d,%lld,%lld,%llu,%llu\n", t->tc, t->th, t->tw, t->tf,
+           t->ifm_bytes, t->weight_bytes, t->dma, t->compute);
+}
+
+#endif // TILING_PLANNER_H
@@ -0,0 +1,138 @@
+// BIẾN ĐỔI WINOGRAD F(m x m, 3 x 3) CHO SỐ NGUYÊN (m = 2 hoặc 4)
+//
+//   Y = A^T [ (G g G^T) .* (B^T d B) ] A
+//
+// G của Winograd có phân số (1/2, 1/6, 1/24...) nên ta dùng G_s = s * G là ma
+// trận nguyên (s = 2 với F(2,3), s = 24 với F(4,3)). Khi đó:
+//
+//   Y = A^T [ (G_s g G_s^T) .* (B^T d B) ] A / s^2
+//
+// Tử số luôn chia hết cho s^2 (vì Y thật là số nguyên) nên phép chia là CHÍNH XÁC.
+// Mọi giá trị trung gian dùng int64 để không tràn khi cộng dồn nhiều channel
+// (với F(4,3): |U| tới 576*128, |V| tới 100*128).
+//
+// Ký hiệu: alpha = m + 2 là kích thước tile input (4 hoặc 6).
+#ifndef WINOGRAD_H
+#define WINOGRAD_H
+
+#include <stdint.h>
+
+#define WINO_MAX_ALPHA 6
+
+typedef struct {
+    int m;          // Kích thước tile output
+    int alpha;      // Kích thước tile input = m + 2
+    int scale;      // s: G_s = s * G
+    const int* BT;  // [alpha][alpha]
+    const int* G;   // [alpha][3] (đã nhân s)
+    const int* AT;  // [m][alpha]
+} winograd_cfg;
+
+// --- F(2x2, 3x3) ---
+static const int WINO_F2_BT[4 * 4] = {
+    1,  0, -1,  0,
+    0,  1,  1,  0,
+    0, -1,  1,  0,
+    0,  1,  0, -1,
+};
+static const int WINO_F2_G[4 * 3] = {   // 2 * G
+    2,  0,  0,
+    1,  1,  1,
+    1, -1,  1,
+    0,  0,  2,
+};
+static const int WINO_F2_AT[2 * 4] = {
+    1,  1,  1,  0,
+    0,  1, -1, -1,
+};
+
+// --- F(4x4, 3x3) ---
+static const int WINO_F4_BT[6 * 6] = {
+    4,  0, -5,  0,  1,  0,
+    0, -4, -4,  1,  1,  0,
+    0,  4, -4, -1,  1,  0,
+    0, -2, -1,  2,  1,  0,
+    0,  2, -1, -2,  1,  0,
+    0,  4,  0, -5,  0,  1,
+};
+static const int WINO_F4_G[6 * 3] = {   // 24 * G
+    6,  0,  0,
+   -4, -4, -4,
+   -4,  4, -4,
+    1,  2,  4,
+    1, -2,  4,
+    0,  0, 24,
+};
+static const int WINO_F4_AT[4 * 6] = {
+    1,  1,  1,  1,  1,  0,
+    0,  1, -1,  2, -2,  0,
+    0,  1,  1,  4,  4,  0,
+    0,  1, -1,  8, -8,  1,
+};
+
+static const winograd_cfg WINO_F2 = { 2, 4, 2,  WINO_F2_BT, WINO_F2_G, WINO_F2_AT };
+static const winograd_cfg WINO_F4 = { 4, 6, 24, WINO_F4_BT, WINO_F4_G, WINO_F4_AT };
+
+// Trả về cấu hình cho m = 2 hoặc 4, NULL nếu không hỗ trợ
+static inline const winograd_cfg* winograd_get(int m) {
+    if (m == 2) return &WINO_F2;
+    if (m == 4) return &WINO_F4;
+    return 0;
+}
+
+// U = G_s g G_s^T   (g: 3x3, U: alpha x alpha)
+static inline void winograd_transform_weight(const winograd_cfg* w, const int32_t* g, int64_t* U) {
+    int a = w->alpha;
+    int64_t tmp[WINO_MAX_ALPHA * 3];
+    for (int i = 0; i < a; i++)
+        for (int j = 0; j < 3; j++) {
+            int64_t s = 0;
+            for (int k = 0; k < 3; k++) s += (int64_t)w->G[i * 3 + k] * g[k * 3 + j];
+            tmp[i * 3 + j] = s;
+        }
+    for (int i = 0; i < a; i++)
+        for (int j = 0; j < a; j++) {
+            int64_t s = 0;
+            for (int k = 0; k < 3; k++) s += tmp[i * 3 + k] * w->G[j * 3 + k];
+            U[i * a + j] = s;
+        }
+}
+
+// V = B^T d B   (d, V: alpha x alpha)
+static inline void winograd_transform_input(const winograd_cfg* w, const int32_t* d, int64_t* V) {
+    int a = w->alpha;
+    int64_t tmp[WINO_MAX_ALPHA * WINO_MAX_ALPHA];
+    for (int i = 0; i < a; i++)
+        for (int j = 0; j < a; j++) {
+            int64_t s = 0;
+            for (int k = 0; k < a; k++) s += (int64_t)w->BT[i * a + k] * d[k * a + j];
+            tmp[i * a + j] = s;
+        }
+    for (int i = 0; i < a; i++)
+        for (int j = 0; j < a; j++) {
+            int64_t s = 0;
+            for (int k = 0; k < a; k++) s += tmp[i * a + k] * w->BT[j * a + k];
+            V[i * a + j] = s;
+        }
+}
+
+// Y = A^T M A / s^2   (M: alpha x alpha, Y: m x m)
+static inline void winograd_transform_output(const winograd_cfg* w, const int64_t* M, int64_t* Y) {
+    int a = w->alpha, m = w->m;
+    int64_t tmp[WINO_MAX_ALPHA * WINO_MAX_ALPHA];
+    for (int i = 0; i < m; i++)
+        for (int j = 0; j < a; j++) {
+            int64_t s = 0;
+            for (int k = 0; k < a; k++) s += (int64_t)w->AT[i * a + k] * M[k * a + j];
+            tmp[i * a + j] = s;
+        }
+    int64_t div = (int64_t)w->scale * w->scale;
+    for (int i = 0; i < m; i++)
+        for (int j = 0; j < m; j++) {
+            int64_t s = 0;
+            for (int k = 0; k < a; k++) s += tmp[i * a + k] * w->AT[j * a + k];
+            Y[i * m + j] = s / div;
+        }
+}
+
+#endif // WINOGRAD_H
@@ -4,100 +4,7 @@
 #include <stdint.h>
 #include <string.h>
 #include <math.h>
-
-// --- CẤU HÌNH BÀI TOÁN ---
-// #define INPUT_H 112
-// #define INPUT_W 112
-// #define INPUT_C 32
-// #define KERNEL_H 3
-// #define KERNEL_W 3
-// #define OUTPUT_F 1 
-// #define OUTPUT_H 112
-// #define OUTPUT_W 112
-// #define STRIDE 1
-// #define PADDING 1
-int INPUT_H, INPUT_W, INPUT_C;
-int KERNEL_H, KERNEL_W;
-int OUTPUT_F, OUTPUT_H, OUTPUT_W;
-int STRIDE, PADDING;
-
-// --- CẤU HÌNH PHẦN CỨNG (HW SPEC) ---
-// #define NUM_PE 48               
-// #define MACS_PER_PE 3           
-// #define BUFFER_SIZE_BYTES 144   // 48 PE * 3 inputs * 1 byte
-// #define PARALLEL_CHANNELS 16    // Số channel xử lý song song
-int NUM_PE, MACS_PER_PE, BUFFER_SIZE_BYTES;
-int PARALLEL_CHANNELS;
-
-// --- CẤU HÌNH HIỆU NĂNG (PERFORMANCE METRICS) ---
-#define DRAM_BUS_WIDTH_BYTES 8  // Bus 64-bit (8 bytes/cycle)
-#define PE_COMPUTE_CYCLES 1     // Số cycle để PE array hoàn thành tính toán 
-
-// Biến toàn cục để lưu thống kê
-unsigned long long total_dma_cycles = 0;
-unsigned long long total_compute_cycles = 0;
-unsigned long long total_cycles = 0;
-
-// MÔ PHỎNG DRAM
-int8_t* ifm_dram;       
-int8_t* weight_dram;    
-int32_t* ofm_dram;      
-
-void dram_init() {
-    ifm_dram = (int8_t*)malloc(INPUT_H * INPUT_W * INPUT_C * sizeof(int8_t));
-    // Load IFM
-    FILE* f_ifm = fopen("../params/ifm.txt", "r");
-    if(f_ifm) {
-        char line[64];
-        
-        for (int h = 0; h < INPUT_H; h++) {
-            for (int w = 0; w < INPUT_W; w++) {
-                for (int c = 0; c < INPUT_C; c++) {
-                    
-                    if (fgets(line, 64, f_ifm)) {
-                        // Chuyển từ chuỗi sang số nguyên 
-                        int val = atoi(line);
-                        // Xử lý số nguyên có dấu 8-bit 
-                        if (val > 0x7F) {
-                            val -= 0x100;
-                        }
-                        // Công thức: index = h * (W * C) + w * C + c
-                        // [h, w, c]
-                        int idx = h * (INPUT_W * INPUT_C) + w * INPUT_C + c;
-                        // Gán vào DRAM 
-                        ifm_dram[idx] = (int8_t)val;
-                    }
-                }
-            }
-        }
-        fclose(f_ifm);
-    } else {
-        printf("Error: Could not open ../params/ifm.txt\n");
-        memset(ifm_dram, 1, INPUT_H * INPUT_W * INPUT_C); 
-    }
-
-    weight_dram = (int8_t*)calloc(KERNEL_H * KERNEL_W * INPUT_C * OUTPUT_F, sizeof(int8_t));
-    // Load Weights
-    FILE* f_w = fopen("../params/weights.txt", "r");
-    if(f_w) {
-        char line[64];
-        //WEIGHTS: C->W->H->F
-        for(int f=0; f<OUTPUT_F; f++)
-            for(int h=0; h<KERNEL_H; h++)
-                for(int w=0; w<KERNEL_W; w++)
-                    for(int c=0; c<INPUT_C; c++)
-                        if(fgets(line, 64, f_w)) {
-                             int val = atoi(line);
-                             if (val > 0x7F) val -= 0x100;
-                             //cho tinh idx nay dung voi [h, w, c, f] trong python
-                             int idx = h*(KERNEL_W*INPUT_C*OUTPUT_F) + w*(INPUT_C*OUTPUT_F) + c*OUTPUT_F + f;
-                             weight_dram[idx] = (int8_t)val;
-                        }
-        fclose(f_w);
-    }
-
-    ofm_dram = (int32_t*)malloc(OUTPUT_H * OUTPUT_W * OUTPUT_F * sizeof(int32_t));
-}
+#include "../common/sim_core.h"
 
 // // MÔ PHỎNG BUFFER & DMA
 // int8_t buffer_ifm[BUFFER_SIZE_BYTES];
@@ -105,90 +12,86 @@ void dram_init() {
 int8_t* buffer_ifm;   
 int8_t* buffer_weight;
 
-// Hàm trả về số cycle tiêu tốn cho việc load DMA
-int dma_load_buffers(int ho, int wo, int pass_idx) {
-    // Reset buffer
-    memset(buffer_ifm, 0, BUFFER_SIZE_BYTES);
-    memset(buffer_weight, 0, BUFFER_SIZE_BYTES);
-
+// Hàm load DMA, trả về số cycle tiêu tốn
+// IFM chỉ load ở filter đầu tiên (f == 0), các filter sau dùng lại cửa sổ IFM trong buffer_ifm.
+// Weight của filter f luôn phải load lại (Tiling không giữ weight).
+int dma_load_buffers(int ho, int wo, int pass_idx, int f) {
     int channel_start = pass_idx * PARALLEL_CHANNELS; //tinh channel bat dau chay
-    int buffer_ptr = 0; 
-    int bytes_transferred = 0; // Đếm số byte thực tế cần load
-
-    for (int i = 0; i < PARALLEL_CHANNELS; i++) {
-        int current_c = channel_start + i;
-        if (current_c >= INPUT_C) break; 
-
-        for (int kh = 0; kh < KERNEL_H; kh++) {
-            for (int kw = 0; kw < KERNEL_W; kw++) {
-                // Fetch IFM
-                int hi = ho * STRIDE + kh - PADDING;
-                int wi = wo * STRIDE + kw - PADDING;
-                int8_t val_ifm = 0;
-                if (hi >= 0 && hi < INPUT_H && wi >= 0 && wi < INPUT_W) {
-                    // IFM: C->W->H
-                    int dram_idx = hi * (INPUT_W * INPUT_C) + wi * INPUT_C + current_c;
-                    val_ifm = ifm_dram[dram_idx];
-                }
-
-                // Fetch Weight
-                //WEIGHTS: F->C->W->H
-                int w_dram_idx = kh * (KERNEL_W * INPUT_C * OUTPUT_F) + 
-                                 kw * (INPUT_C * OUTPUT_F) + 
-                                 current_c * OUTPUT_F + 0;
-                int8_t val_w = weight_dram[w_dram_idx];
-
-                buffer_ifm[buffer_ptr] = val_ifm;
-                buffer_weight[buffer_ptr] = val_w;
-                buffer_ptr++;
-                
-                // Mỗi phần tử load 2 byte (1 byte IFM + 1 byte Weight)
-                // Ta tính tổng bytes cần chuyển vào buffer
-                bytes_transferred += 2; 
-            }
-        }
+    int nc = (INPUT_C - channel_start < PARALLEL_CHANNELS) ? INPUT_C - channel_start : PARALLEL_CHANNELS;
+    int kernel_size = KERNEL_H * KERNEL_W;
+
+    // Buffer layout [kh][kw][channel] (giống NHWC của IFM): cửa sổ IFM là 1 descriptor 3D,
+    // weight của filter f là 1 descriptor 2D (bước OUTPUT_F giữa các channel)
+    // IFM chỉ ở filter đầu tiên; byte padding vẫn đi qua DMA (ghi 0)
+    int ifm_bytes = (f == 0) ? nc * kernel_size : 0;
+    int weight_bytes = nc * kernel_size;
+    if (f == 0) {
+        sim_desc_ifm(buffer_ifm, ho * STRIDE - PADDING, wo * STRIDE - PADDING, channel_start, nc,
+                     KERNEL_H, KERNEL_W, (long long)KERNEL_W * nc, nc);
+        sram_touch(&ifm_sram, 0, ifm_bytes);
     }
 
     // --- TÍNH TOÁN LATENCY ---
-    // Tổng dung lượng cần load vào Buffer: 144 bytes (cho IFM) + 144 bytes (cho Weight) = 288 bytes?
-    // Code trên ghi vào 2 buffer riêng, tổng dung lượng tối đa là 144 * 2 = 288 bytes.
-    // Tuy nhiên buffer_size định nghĩa là 144 bytes chia sẻ hay riêng?
-    // Giả sử 2 port DMA độc lập hoặc chung bus.
-    // Ta tính tổng bytes load từ DRAM chia cho Bandwidth.
-    // buffer_ptr là số phần tử (cặp). Tổng bytes = buffer_ptr * 2 (1 ifm + 1 weight).
-    
-    int total_bytes = buffer_ptr * 2; 
-    
-    // Số cycle = ceil(total_bytes / bus_width)
-    // + Latency khởi tạo DMA (overhead), giả sử 0 hoặc 5 cycles. Ta lấy 0 cho lý tưởng.
-    int cycles = (total_bytes + DRAM_BUS_WIDTH_BYTES - 1) / DRAM_BUS_WIDTH_BYTES;
-    
-    return cycles;
+    // Nhiều kênh DMA (SIM_DMA_CHANNELS > 1): IFM và Weight đi trên 2 kênh riêng
+    sim_time cycles = 0;
+    if (f == 0 && dma_num_channels > 1) {
+        cycles = sim_dma_load(DMA_CH_IFM, ifm_bytes, &ifm_buf, NULL);
+    }
+    sim_desc_weight(buffer_weight, f, channel_start, nc, nc);
+    sram_touch(&weight_sram, 0, weight_bytes);
+    if (f == 0 && dma_num_channels > 1) {
+        return (int)(cycles + sim_dma_load(DMA_CH_WEIGHT, weight_bytes, &weight_buf, NULL));
+    }
+
+    // Tổng bytes load từ DRAM (IFM + Weight) chia cho Bandwidth, IFM và Weight chung bus.
+    // Với OUTPUT_F filter: IFM 144 bytes chỉ tốn 1 lần / pass, Weight 144 bytes mỗi filter.
+    // Số cycle = ceil(total_bytes / bus_width) (SIM_DRAM=1: mô hình burst / row buffer)
+    // + khởi tạo SIM_DMA_SETUP chu kỳ / descriptor (IFM + Weight: 2 descriptor) + độ trễ DRAM
+    int total_bytes = ifm_bytes + weight_bytes;
+    return (int)sim_dma_load(DMA_CH_WEIGHT, total_bytes, &weight_buf, (f == 0) ? &ifm_buf : NULL);
 }
 
 // MÔ PHỎNG COMPUTE ENGINE
-int32_t run_pe_array(int* cycles_taken) {
-    int32_t partial_sum = 0;
-
-    // Logic tính toán chức năng (Functional)
-    for (int pe_id = 0; pe_id < NUM_PE; pe_id++) {
-        int base_idx = pe_id * MACS_PER_PE; 
-        int32_t pe_acc = 0; 
-        for (int k = 0; k < MACS_PER_PE; k++) {//tinh het so MAC cua 1 con PE
-            int8_t a = buffer_ifm[base_idx + k];
-            int8_t b = buffer_weight[base_idx + k];
-            pe_acc += (int32_t)a * (int32_t)b;
-        }
-        partial_sum += pe_acc; // tong cua 48 con PE
-    }
+int32_t run_pe_array(int pass_idx, int* cycles_taken) {
+    // num_c x KERNEL_H x KERNEL_W phép MAC được gom thành 1 tích vô hướng int8 (kernel SIMD)
+    // Pass cuối có thể ít channel hơn PARALLEL_CHANNELS: các PE còn lại ngồi không
+    int num_c = INPUT_C - pass_idx * PARALLEL_CHANNELS;
+    if (num_c > PARALLEL_CHANNELS) num_c = PARALLEL_CHANNELS;
+    int n = num_c * KERNEL_H * KERNEL_W;
+    int32_t partial_sum = pe_dot_i8(buffer_ifm, buffer_weight, n);
 
     // --- TÍNH TOÁN LATENCY ---
     // Các PE chạy song song -> Chỉ tốn thời gian của PE chậm nhất (đều nhau).
-    *cycles_taken = PE_COMPUTE_CYCLES;
+    // Tất cả PE đọc buffer cùng lúc -> có thể kéo dài nếu bank SRAM bị conflict
+    // Năng lượng: n MAC, đọc IFM + Weight từ buffer
+    sim_pe_energy(n, 2 * n);
+    sram_touch(&ifm_sram, 0, n);
+    sram_touch(&weight_sram, 0, n);
+    // Lượt đầu của pass mới: fill + drain pipeline (SIM_PE_MODEL, common/pe_timing.h)
+    *cycles_taken = (int)(sim_read_cycles(PE_COMPUTE_CYCLES) + pe_timing_ramp(pass_idx));
+    // Utilization: n MAC trải phẳng từ PE 0 trong 1 lượt
+    pe_util_fill(pass_idx, n, PE_COMPUTE_CYCLES);
 
     return partial_sum;
 }
 
+// MÔ HÌNH TILE (common/tiling_planner.h)
+// Tiling chỉ chia channel: IFM và Weight của 1 pass đều là tc x KERNEL_H x KERNEL_W byte.
+// Mỗi pixel, mỗi pass: lần truyền đầu chở IFM + Weight, OUTPUT_F-1 lần sau chỉ chở Weight;
+// mỗi pixel ghi kết quả cuối 1 lần
+void plan_model_tl(tile_plan* t) {
+    int kernel_size = KERNEL_H * KERNEL_W;
+    unsigned long long pixels = (unsigned long long)OUTPUT_H * OUTPUT_W;
+    t->ifm_bytes = t->weight_bytes = (long long)t->tc * kernel_size;
+    for (int c0 = 0; c0 < INPUT_C; c0 += t->tc) {
+        int nc = (INPUT_C - c0 < t->tc) ? INPUT_C - c0 : t->tc;
+        t->dma += pixels * (sim_xfer_cycles(2LL * nc * kernel_size, 2) +
+                            (OUTPUT_F - 1) * sim_xfer_cycles((long long)nc * kernel_size, 1));
+        t->compute += pixels * OUTPUT_F * PE_COMPUTE_CYCLES;
+    }
+    t->dma += pixels * sim_psum_xfer_cycles(OUTPUT_F, 1, 1, 0);
+}
+
 // CONTROLLER & REPORT
 void run_accelerator() {
     // printf("--- STARTING SIMULATION ---\n");
@@ -200,35 +103,40 @@ void run_accelerator() {
 
     int num_passes = (INPUT_C + PARALLEL_CHANNELS - 1) / PARALLEL_CHANNELS;//de dam bao luon lam tron len
     
-    // Reset Stats
-    total_dma_cycles = 0;
-    total_compute_cycles = 0;
+    // Accumulator cho từng filter của pixel hiện tại
+    int32_t* final_accumulator = (int32_t*)malloc(OUTPUT_F * sizeof(int32_t));
 
     // Main Loop
     for (int ho = 0; ho < OUTPUT_H; ho++) {
         for (int wo = 0; wo < OUTPUT_W; wo++) {
             
-            int32_t final_accumulator = 0; //reset accum cho moi vi tri width
+            memset(final_accumulator, 0, OUTPUT_F * sizeof(int32_t)); //reset accum cho moi vi tri width
 
             for (int p = 0; p < num_passes; p++) {
-                
-                // DMA Load
-                int dma_c = dma_load_buffers(ho, wo, p);
-                total_dma_cycles += dma_c;
-
-                // Compute
-                int comp_c = 0;
-                int32_t pass_result = run_pe_array(&comp_c);//PE tinh toan xong gan vao pass_result
-                total_compute_cycles += comp_c;
-                final_accumulator += pass_result; //cong ket qua cua cac PE vao accum
+                // Cửa sổ IFM của pass được dùng lại cho tất cả filter
+                for (int f = 0; f < OUTPUT_F; f++) {
+                    
+                    // DMA Load (IFM + Weight chung 1 lần truyền ở filter đầu tiên)
+                    dma_load_buffers(ho, wo, p, f);
+
+                    // Compute
+                    int comp_c = 0;
+                    int32_t pass_result = run_pe_array(p, &comp_c);//PE tinh toan xong gan vao pass_result
+                    sim_compute(&pe_array, comp_c, &ifm_buf, &weight_buf);
+                    final_accumulator[f] += pass_result; //cong ket qua cua cac PE vao accum
+                }
             }
 
-            int out_idx = ho * OUTPUT_W + wo; // tinh vi tri luu trong output
-            ofm_dram[out_idx] = final_accumulator;
+            // OFM layout: [ho][wo][fo]
+            for (int f = 0; f < OUTPUT_F; f++) {
+                int out_idx = (ho * OUTPUT_W + wo) * OUTPUT_F + f; // tinh vi tri luu trong output
+                ofm_dram[out_idx] = final_accumulator[f];
+            }
+            // Accumulator giữ psum qua mọi pass -> chỉ ghi kết quả cuối của pixel 1 lần
+            sim_psum_update((ho * OUTPUT_W + wo) * OUTPUT_F, OUTPUT_F, 1, 1);
         }
     }
-    
-    total_cycles = total_dma_cycles + total_compute_cycles;
+    free(final_accumulator);
 
     // --- REPORT KẾT QUẢ ---
     
@@ -241,19 +149,6 @@ void run_accelerator() {
     // printf("--------------------------\n");
 }
 
-void write_dram_to_file() {
-    FILE* f = fopen("../ofm/ofm.txt", "w");
-    if (!f) return;
-    for(int i=0; i<OUTPUT_H*OUTPUT_W; i++) fprintf(f, "%d\n", ofm_dram[i]);
-    fclose(f);
-}
-
-void cleanup() {
-    free(ifm_dram);
-    free(weight_dram);
-    free(ofm_dram);
-}
-
 // int main() {
 //     dram_init();
 //     run_accelerator();
@@ -263,48 +158,25 @@ void cleanup() {
 // }
 
 int main(int argc, char *argv[]) {
-    // Kiểm tra số lượng tham số đầu vào
-    // Cần 13 tham số + 1 tên chương trình = 14
-    if (argc < 14) {
-        printf("Usage: %s IH IW IC KH KW OF OH OW S P NPE MAC BUF\n", argv[0]);
-        return -1;
-    }
-
-    // Gán giá trị từ Terminal vào biến
-    INPUT_H = atoi(argv[1]);
-    INPUT_W = atoi(argv[2]);
-    INPUT_C = atoi(argv[3]);
-    KERNEL_H = atoi(argv[4]);
-    KERNEL_W = atoi(argv[5]);
-    OUTPUT_F = atoi(argv[6]);
-    OUTPUT_H = atoi(argv[7]);
-    OUTPUT_W = atoi(argv[8]);
-    STRIDE = atoi(argv[9]);
-    PADDING = atoi(argv[10]);
-    NUM_PE = atoi(argv[11]);
-    MACS_PER_PE = atoi(argv[12]);
-    BUFFER_SIZE_BYTES = atoi(argv[13]);
-
-    // Tự động tính toán PARALLEL_CHANNELS
-    // Logic: Tổng số MAC / kích thước 1 channel
-    // Ví dụ: (48 * 3) / (3 * 3) = 144 / 9 = 16
-    if (KERNEL_H * KERNEL_W > 0) {
-        PARALLEL_CHANNELS = (NUM_PE * MACS_PER_PE) / (KERNEL_H * KERNEL_W);
-    } else {
-        PARALLEL_CHANNELS = 1; // Tránh chia cho 0
-    }
+    // Đọc 13 tham số + tính PARALLEL_CHANNELS (common/sim_core.h)
+    if (sim_parse_args(argc, argv, "") < 0) return -1;
     // printf("--- Auto-calculated PARALLEL_CHANNELS: %d ---\n", PARALLEL_CHANNELS);
+    // Chọn số channel / pass vừa BUFFER_SIZE_BYTES
+    if (sim_plan_tiling(1, 1, 1, plan_model_tl) < 0) return -1;
 
     // Cấp phát bộ nhớ cho Buffer
     buffer_ifm = (int8_t*)malloc(BUFFER_SIZE_BYTES * sizeof(int8_t));
     buffer_weight = (int8_t*)malloc(BUFFER_SIZE_BYTES * sizeof(int8_t));
 
     // Chạy các hàm 
+    sim_init();
+    // GLB (SIM_GLB=1): weight được load lại ở mọi pixel -> ưu tiên giữ toàn bộ weight, phần còn lại cho IFM
+    glb_keep(DRAM_WEIGHT, (long long)KERNEL_H * KERNEL_W * INPUT_C * OUTPUT_F);
+    glb_keep(DRAM_IFM, (long long)INPUT_H * INPUT_W * INPUT_C);
     dram_init();
     run_accelerator();
     write_dram_to_file();
-    unsigned long long total = total_dma_cycles + total_compute_cycles;
-    printf("SURVEY_RESULT,%llu,%llu,%llu\n", total_dma_cycles, total_compute_cycles, total);
+    sim_report();
     // ---------------------
 
     // Dọn dẹp bộ nhớ buffer mới cấp phát
@@ -0,0 +1,197 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "../common/sim_core.h"
+
+// --- BUFFER ON-CHIP ---
+// int8_t buffer_ifm[BUFFER_SIZE_BYTES];   
+// int8_t buffer_weight[BUFFER_SIZE_BYTES]; 
+int8_t* buffer_ifm;   
+int8_t* buffer_weight;
+
+
+// --- OUTPUT STATIONARY ---
+// Mỗi PE giữ cố định 1 pixel output (TILE_PIX <= NUM_PE pixel liên tiếp trên cùng 1 hàng ho).
+// Accumulator của PE nằm on-chip suốt mọi pass channel -> KHÔNG có đọc-sửa-ghi
+// ofm_dram giữa các pass, chỉ ghi kết quả cuối 1 lần khi xong khối pixel.
+// Mỗi chu kỳ, mỗi PE làm MACS_PER_PE phép MAC trên cửa sổ của chính nó,
+// weight được broadcast tới mọi PE.
+int32_t* acc_buffer;    // [pe][f]: NUM_PE x OUTPUT_F accumulator on-chip
+int TILE_PIX;           // Số pixel output / khối (sim_plan.tw, <= NUM_PE)
+int TILE_W;             // Số cột IFM của 1 khối: (TILE_PIX-1)*STRIDE + KERNEL_W
+int FILTER_GROUP;       // Số filter có weight nằm trong buffer cùng lúc (sim_plan.tf)
+
+// CÁC HÀM DMA
+
+// Load IFM cho khối TILE_PIX pixel (hàng ho, bắt đầu từ wo0) của 1 pass
+// Layout buffer: [kh][cột][channel] -> cửa sổ 1 hàng kernel của mỗi PE liên tục trong bộ nhớ
+// Các pixel kề nhau dùng chung phần chồng lấn (halo) nên chỉ load 1 lần: 1 descriptor 3D
+// Khối cuối hàng ít pixel hơn chỉ load (num_pixels-1)*STRIDE + KERNEL_W cột nó cần
+void dma_load_ifm_block(int ho, int wo0, int num_pixels, int pass_idx) {
+    int channel_start = pass_idx * PARALLEL_CHANNELS;
+    int nc = (INPUT_C - channel_start < PARALLEL_CHANNELS) ? INPUT_C - channel_start : PARALLEL_CHANNELS;
+    int cols = (num_pixels - 1) * STRIDE + KERNEL_W;
+    int block_bytes = KERNEL_H * TILE_W * PARALLEL_CHANNELS;
+
+    // Pass cuối thiếu channel: các channel còn lại của mỗi ô phải là 0
+    if (nc < PARALLEL_CHANNELS) memset(buffer_ifm, 0, block_bytes);
+    sim_desc_ifm(buffer_ifm, ho * STRIDE - PADDING, wo0 * STRIDE - PADDING, channel_start, nc,
+                 KERNEL_H, cols, (long long)TILE_W * PARALLEL_CHANNELS, PARALLEL_CHANNELS);
+    for (int kh = 0; kh < KERNEL_H; kh++) {
+        sram_touch(&ifm_sram, (long long)kh * TILE_W * PARALLEL_CHANNELS, cols * PARALLEL_CHANNELS);
+    }
+    sim_dma_load(DMA_CH_IFM, KERNEL_H * cols * nc, &ifm_buf, NULL);
+}
+
+// Load weight của 1 pass cho nhóm filter [f0, f0 + num_f) (broadcast tới mọi PE)
+// Bank filter f: buffer_weight + (f - f0) * KERNEL_H*KERNEL_W*PARALLEL_CHANNELS, layout [kh][kw][channel]
+// Mỗi filter 1 descriptor 2D
+void dma_load_weights(int pass_idx, int f0, int num_f) {
+    int channel_start = pass_idx * PARALLEL_CHANNELS;
+    int nc = (INPUT_C - channel_start < PARALLEL_CHANNELS) ? INPUT_C - channel_start : PARALLEL_CHANNELS;
+    int bank_size = KERNEL_H * KERNEL_W * PARALLEL_CHANNELS;
+    if (nc < PARALLEL_CHANNELS) memset(buffer_weight, 0, (size_t)num_f * bank_size);
+    for (int f = f0; f < f0 + num_f; f++) {
+        sim_desc_weight(buffer_weight + (f - f0) * bank_size, f, channel_start, nc, PARALLEL_CHANNELS);
+    }
+    sram_touch(&weight_sram, 0, (long long)num_f * bank_size);
+    sim_dma_load(DMA_CH_WEIGHT, num_f * KERNEL_H * KERNEL_W * nc, &weight_buf, NULL);
+}
+
+// COMPUTE ENGINE
+
+// Filter f (weight ở bank slot của nhóm), 1 pass: PE thứ pe cộng dồn cửa sổ
+// KERNEL_H x KERNEL_W x PARALLEL_CHANNELS vào acc của nó
+// num_pixels < NUM_PE (khối nhỏ hoặc khối cuối hàng) -> các PE thừa ngồi không nhưng vẫn tốn chu kỳ
+void run_pe_array(int pass_idx, int f, int slot, int num_pixels) {
+    int row_len = KERNEL_W * PARALLEL_CHANNELS;
+    const int8_t* bank = buffer_weight + slot * (KERNEL_H * row_len);
+    for (int pe = 0; pe < num_pixels; pe++) {
+        int32_t sum = 0;
+        for (int kh = 0; kh < KERNEL_H; kh++) {
+            const int8_t* win = buffer_ifm + (kh * TILE_W + pe * STRIDE) * PARALLEL_CHANNELS;
+            sum += pe_dot_i8(win, bank + kh * row_len, row_len);
+            sram_touch(&ifm_sram, win - buffer_ifm, row_len);
+        }
+        acc_buffer[pe * OUTPUT_F + f] += sum;
+    }
+    // Weight của filter f broadcast tới mọi PE
+    sram_touch(&weight_sram, bank - buffer_weight, KERNEL_H * row_len);
+    // Mỗi PE xử lý KERNEL_H*KERNEL_W*PARALLEL_CHANNELS MAC, MACS_PER_PE MAC / chu kỳ
+    int macs_per_pixel = KERNEL_H * row_len;
+    sim_time cycles = (sim_time)((macs_per_pixel + MACS_PER_PE - 1) / MACS_PER_PE) * PE_COMPUTE_CYCLES;
+    // Năng lượng: mỗi PE đọc cửa sổ IFM của nó, Weight đọc 1 lần rồi broadcast
+    sim_pe_energy((unsigned long long)num_pixels * macs_per_pixel, (unsigned long long)(num_pixels + 1) * macs_per_pixel);
+    sim_compute(&pe_array, sim_read_cycles(cycles), &ifm_buf, &weight_buf);
+    // Utilization: num_pixels PE đầu làm macs_per_pixel MAC, số PE còn lại của khối ngồi không
+    pe_util_slots(pass_idx, cycles);
+    pe_util_pe(pass_idx, 0, num_pixels, macs_per_pixel);
+}
+
+// MÔ HÌNH TILE (common/tiling_planner.h)
+// Buffer IFM: khối KERNEL_H x ((tw-1)*STRIDE + KERNEL_W) x tc; buffer Weight: tf bank KERNEL_H x KERNEL_W x tc.
+// Mỗi khối tw pixel, mỗi pass: load IFM 1 lần (khối cuối hàng chỉ load cột nó cần), weight theo từng
+// nhóm tf filter; mỗi filter tốn ceil(KERNEL_H*KERNEL_W*tc / MACS_PER_PE) chu kỳ dù khối ít pixel;
+// khối IFM 1 descriptor, weight 1 descriptor / filter; mỗi khối ghi kết quả cuối 1 lần.
+// Các tw cho cùng số khối / hàng có cùng compute và cùng số cột IFM -> bằng nhau, planner giữ tw lớn hơn
+// (nhiều PE có việc hơn, khối cuối nhỏ hơn)
+void plan_model_os(tile_plan* t) {
+    int kernel_size = KERNEL_H * KERNEL_W;
+    int tile_w = (t->tw - 1) * STRIDE + KERNEL_W;
+    int tail = OUTPUT_W % t->tw;
+    int tail_w = (tail - 1) * STRIDE + KERNEL_W;
+    unsigned long long full = (unsigned long long)OUTPUT_H * (OUTPUT_W / t->tw);
+    unsigned long long blocks = full + (tail ? OUTPUT_H : 0);
+    t->ifm_bytes = (long long)KERNEL_H * tile_w * t->tc;
+    t->weight_bytes = (long long)kernel_size * t->tc * t->tf;
+    unsigned long long cycles = (kernel_size * t->tc + MACS_PER_PE - 1) / MACS_PER_PE * PE_COMPUTE_CYCLES;
+    for (int c0 = 0; c0 < INPUT_C; c0 += t->tc) {
+        int nc = (INPUT_C - c0 < t->tc) ? INPUT_C - c0 : t->tc;
+        t->dma += full * sim_xfer_cycles((long long)KERNEL_H * tile_w * nc, 1);
+        if (tail) t->dma += OUTPUT_H * sim_xfer_cycles((long long)KERNEL_H * tail_w * nc, 1);
+        for (int f0 = 0; f0 < OUTPUT_F; f0 += t->tf) {
+            int nf = (OUTPUT_F - f0 < t->tf) ? OUTPUT_F - f0 : t->tf;
+            t->dma += blocks * sim_xfer_cycles((long long)kernel_size * nc * nf, nf);
+        }
+        t->compute += blocks * OUTPUT_F * cycles;
+    }
+    t->dma += full * sim_psum_xfer_cycles((long long)t->tw * OUTPUT_F, 1, 1, 0);
+    if (tail) t->dma += OUTPUT_H * sim_psum_xfer_cycles((long long)tail * OUTPUT_F, 1, 1, 0);
+}
+
+// CONTROLLER: OUTPUT STATIONARY
+
+void run_accelerator_os() {
+    int num_passes = (INPUT_C + PARALLEL_CHANNELS - 1) / PARALLEL_CHANNELS;
+
+    for (int ho = 0; ho < OUTPUT_H; ho++) {
+        for (int wo0 = 0; wo0 < OUTPUT_W; wo0 += TILE_PIX) {
+            int num_pixels = (OUTPUT_W - wo0 < TILE_PIX) ? (OUTPUT_W - wo0) : TILE_PIX;
+
+            // Reset accumulator on-chip cho khối pixel mới
+            memset(acc_buffer, 0, NUM_PE * OUTPUT_F * sizeof(int32_t));
+
+            // Loop Pass: accumulator đứng yên, IFM + Weight chảy qua
+            for (int p = 0; p < num_passes; p++) {
+                dma_load_ifm_block(ho, wo0, num_pixels, p);
+                // Buffer Weight chỉ chứa FILTER_GROUP filter -> load theo nhóm
+                for (int f0 = 0; f0 < OUTPUT_F; f0 += FILTER_GROUP) {
+                    int num_f = (OUTPUT_F - f0 < FILTER_GROUP) ? OUTPUT_F - f0 : FILTER_GROUP;
+                    dma_load_weights(p, f0, num_f);
+                    for (int f = f0; f < f0 + num_f; f++) {
+                        run_pe_array(p, f, f - f0, num_pixels);
+                    }
+                }
+            }
+
+            // Ghi kết quả cuối 1 lần (layout [ho][wo][fo] trùng với [pe][f])
+            memcpy(ofm_dram + (ho * OUTPUT_W + wo0) * OUTPUT_F, acc_buffer,
+                   num_pixels * OUTPUT_F * sizeof(int32_t));
+            sim_psum_update((ho * OUTPUT_W + wo0) * OUTPUT_F, num_pixels * OUTPUT_F, 1, 1);
+        }
+    }
+}
+
+int main(int argc, char *argv[]) {
+    // Đọc 13 tham số + tính PARALLEL_CHANNELS (common/sim_core.h)
+    if (sim_parse_args(argc, argv, "") < 0) return -1;
+    if (PARALLEL_CHANNELS < 1) PARALLEL_CHANNELS = 1;
+    int kernel_size = KERNEL_H * KERNEL_W;
+
+    // Chọn số channel / pass, số pixel / khối và số filter / nhóm vừa BUFFER_SIZE_BYTES
+    int max_pix = (NUM_PE < OUTPUT_W) ? NUM_PE : OUTPUT_W;
+    if (sim_plan_tiling(1, max_pix, OUTPUT_F, plan_model_os) < 0) return -1;
+    TILE_PIX = sim_plan.tw;
+    FILTER_GROUP = sim_plan.tf;
+
+    // Cấp phát bộ nhớ động
+    // IFM: 1 khối KERNEL_H x TILE_W x PARALLEL_CHANNELS; Weight: FILTER_GROUP bank, 1 bank / filter
+    TILE_W = (TILE_PIX - 1) * STRIDE + KERNEL_W;
+    buffer_ifm = (int8_t*)malloc(KERNEL_H * TILE_W * PARALLEL_CHANNELS * sizeof(int8_t));
+    buffer_weight = (int8_t*)calloc(kernel_size * PARALLEL_CHANNELS * FILTER_GROUP, sizeof(int8_t));
+    acc_buffer = (int32_t*)calloc(NUM_PE * OUTPUT_F, sizeof(int32_t));
+
+    if (!buffer_ifm || !buffer_weight || !acc_buffer) {
+        printf("Error: Malloc failed\n");
+        return -1;
+    }
+
+    // Chạy mô phỏng
+    sim_init();
+    // GLB (SIM_GLB=1): weight được load lại ở mọi khối pixel -> ưu tiên giữ toàn bộ weight, phần còn lại cho IFM
+    glb_keep(DRAM_WEIGHT, (long long)KERNEL_H * KERNEL_W * INPUT_C * OUTPUT_F);
+    glb_keep(DRAM_IFM, (long long)INPUT_H * INPUT_W * INPUT_C);
+    dram_init();
+    run_accelerator_os();
+    write_dram_to_file();
+    sim_report();
+
+    // Dọn dẹp
+    free(buffer_ifm);
+    free(buffer_weight);
+    free(acc_buffer);
+    cleanup();
+
+    return 0;
+}
@@ -0,0 +1,216 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "../common/sim_core.h"
+
+// --- BUFFER ON-CHIP ---
+// int8_t buffer_ifm[BUFFER_SIZE_BYTES];   
+// int8_t buffer_weight[BUFFER_SIZE_BYTES]; 
+int8_t* buffer_ifm;   
+int8_t* buffer_weight;
+
+
+// --- ROW STATIONARY (kiểu Eyeriss) ---
+// Mảng PE được xếp thành lưới KERNEL_H hàng x RS_COLS cột (RS_COLS = NUM_PE / KERNEL_H).
+//   - PE(i, j) giữ cố định hàng kernel i và hàng IFM (j*STRIDE + i), tính tích chập 1D
+//     của 2 hàng này cho mọi wo -> 1 hàng psum
+//   - Psum chảy dọc theo cột j (i = 0 -> KERNEL_H-1) và cộng lại thành hàng output ho0 + j
+//   - Hàng kernel i được broadcast ngang cho mọi PE ở hàng i
+//   - Hàng IFM r dùng chung cho các PE trên đường chéo i + j*STRIDE = r (diagonal reuse):
+//     chỉ load 1 lần từ DRAM rồi multicast
+// Mỗi PE có MACS_PER_PE MAC chạy song song theo channel.
+// Nếu NUM_PE < KERNEL_H, 1 cột được gập (fold) lên RS_FOLD lần (chạy tuần tự).
+// Hàng output được chia thành đoạn SEG_W cột để hàng IFM của cả nhóm vừa buffer.
+int RS_COLS;            // Số hàng output tính đồng thời (sim_plan.th, <= NUM_PE / KERNEL_H)
+int RS_FOLD;            // Số lần gập kernel khi NUM_PE < KERNEL_H
+int SEG_W;              // Số cột output / đoạn (sim_plan.tw)
+int TILE_W;             // Số cột IFM (kể cả padding) của 1 đoạn: (SEG_W-1)*STRIDE + KERNEL_W
+int MAX_ROWS;           // Số hàng IFM tối đa của 1 nhóm: (RS_COLS-1)*STRIDE + KERNEL_H
+
+// Thống kê diagonal reuse
+unsigned long long ifm_rows_loaded = 0;   // Số hàng IFM thật sự đọc từ DRAM
+unsigned long long ifm_rows_reused = 0;   // Số lần PE nhận hàng IFM nhờ multicast (không đọc lại DRAM)
+
+// CÁC HÀM DMA
+
+// Load các hàng IFM cho nhóm hàng output [ho0, ho0 + num_rows), đoạn cột output bắt đầu từ wo0, của 1 pass
+// Layout buffer: [hàng][cột][channel]; mỗi hàng IFM chỉ load 1 lần dù nhiều PE dùng
+// Cả nhóm hàng là 1 descriptor 3D
+void dma_load_ifm_rows(int ho0, int num_rows, int wo0, int pass_idx) {
+    int channel_start = pass_idx * PARALLEL_CHANNELS;
+    int nc = (INPUT_C - channel_start < PARALLEL_CHANNELS) ? INPUT_C - channel_start : PARALLEL_CHANNELS;
+    int rows_needed = (num_rows - 1) * STRIDE + KERNEL_H;
+    long long block_bytes = (long long)rows_needed * TILE_W * PARALLEL_CHANNELS;
+
+    // Pass cuối thiếu channel: các channel còn lại của mỗi ô phải là 0
+    if (nc < PARALLEL_CHANNELS) memset(buffer_ifm, 0, block_bytes);
+    sim_desc_ifm(buffer_ifm, ho0 * STRIDE - PADDING, wo0 * STRIDE - PADDING, channel_start, nc,
+                 rows_needed, TILE_W, (long long)TILE_W * PARALLEL_CHANNELS, PARALLEL_CHANNELS);
+    // Không reuse: mỗi PE (KERNEL_H x num_rows) tự load 1 hàng
+    ifm_rows_loaded += rows_needed;
+    ifm_rows_reused += (unsigned long long)KERNEL_H * num_rows - rows_needed;
+    sram_touch(&ifm_sram, 0, block_bytes);
+    sim_dma_load(DMA_CH_IFM, rows_needed * TILE_W * nc, &ifm_buf, NULL);
+}
+
+// Load KERNEL_H hàng kernel của filter f cho 1 pass (broadcast ngang)
+// Layout: [kh][kw][channel], 1 descriptor 2D
+void dma_load_weight_rows(int f, int pass_idx) {
+    int channel_start = pass_idx * PARALLEL_CHANNELS;
+    int nc = (INPUT_C - channel_start < PARALLEL_CHANNELS) ? INPUT_C - channel_start : PARALLEL_CHANNELS;
+    int bank_size = KERNEL_H * KERNEL_W * PARALLEL_CHANNELS;
+    if (nc < PARALLEL_CHANNELS) memset(buffer_weight, 0, bank_size);
+    sim_desc_weight(buffer_weight, f, channel_start, nc, PARALLEL_CHANNELS);
+    sram_touch(&weight_sram, 0, bank_size);
+    sim_dma_load(DMA_CH_WEIGHT, KERNEL_H * KERNEL_W * nc, &weight_buf, NULL);
+}
+
+// COMPUTE ENGINE
+
+// Filter f, 1 pass, nhóm hàng output [ho0, ho0 + num_rows), đoạn cột [wo0, wo0 + num_cols)
+void run_pe_array(int pass_idx, int f, int ho0, int num_rows, int wo0, int num_cols) {
+    int row_len = KERNEL_W * PARALLEL_CHANNELS;
+    for (int j = 0; j < num_rows; j++) {
+        int ho = ho0 + j;
+        for (int wo = 0; wo < num_cols; wo++) {
+            // Psum đi dọc cột j qua KERNEL_H PE
+            int32_t psum = 0;
+            for (int i = 0; i < KERNEL_H; i++) {
+                int r = j * STRIDE + i;
+                const int8_t* win = buffer_ifm + (r * TILE_W + wo * STRIDE) * PARALLEL_CHANNELS;
+                psum += pe_dot_i8(win, buffer_weight + i * row_len, row_len);
+                sram_touch(&ifm_sram, win - buffer_ifm, row_len);
+            }
+            ofm_dram[(ho * OUTPUT_W + wo0 + wo) * OUTPUT_F + f] += psum;
+        }
+    }
+    // Mọi PE chạy song song: mỗi pixel của đoạn cần KERNEL_W*PARALLEL_CHANNELS MAC / PE,
+    // cộng thêm KERNEL_H-1 chu kỳ để psum cuối cùng đi hết cột
+    unsigned long long cycles_per_pixel = (row_len + MACS_PER_PE - 1) / MACS_PER_PE;
+    sim_time cycles = ((sim_time)num_cols * cycles_per_pixel * RS_FOLD + (KERNEL_H - 1)) * PE_COMPUTE_CYCLES;
+    // Năng lượng: mỗi PE đọc 1 hàng IFM (TILE_W cột) vào scratchpad, hàng kernel broadcast theo hàng PE
+    unsigned long long macs = (unsigned long long)num_rows * num_cols * KERNEL_H * row_len;
+    sim_pe_energy(macs, (unsigned long long)KERNEL_H * num_rows * TILE_W * PARALLEL_CHANNELS + KERNEL_H * row_len);
+    sram_touch(&weight_sram, 0, KERNEL_H * row_len);
+    sim_compute(&pe_array, sim_read_cycles(cycles), &ifm_buf, &weight_buf);
+    // Utilization: PE(i, j) là PE thứ j * KERNEL_H + i (gập: i % NUM_PE), chỉ num_rows cột đầu có việc;
+    // KERNEL_H-1 chu kỳ psum chảy dọc cột cũng tính vào slot
+    pe_util_slots(pass_idx, cycles);
+    if (RS_FOLD > 1) {
+        for (int i = 0; i < KERNEL_H; i++) pe_util_pe(pass_idx, i % NUM_PE, 1, (unsigned long long)num_cols * row_len);
+    } else {
+        pe_util_pe(pass_idx, 0, num_rows * KERNEL_H, (unsigned long long)num_cols * row_len);
+    }
+}
+
+// MÔ HÌNH TILE (common/tiling_planner.h)
+// Buffer IFM: ((th-1)*STRIDE + KERNEL_H) hàng x ((tw-1)*STRIDE + KERNEL_W) cột x tc; buffer Weight: 1 filter.
+// Mỗi nhóm th hàng, mỗi đoạn tw cột, mỗi pass: load hàng IFM 1 lần, weight load lại cho từng filter;
+// mỗi lượt tính tốn thêm KERNEL_H-1 chu kỳ (psum đi hết cột) nên đoạn càng ngắn càng tốn.
+// Psum: mỗi hàng của nhóm, mỗi đoạn, mỗi pass 1 lần đọc-sửa-ghi (số cột x OUTPUT_F int32);
+// tập cộng dồn dở: th hàng x tw cột x OUTPUT_F
+void plan_model_rs(tile_plan* t) {
+    int kernel_size = KERNEL_H * KERNEL_W;
+    int tile_w = (t->tw - 1) * STRIDE + KERNEL_W;
+    unsigned long long segs = (OUTPUT_W + t->tw - 1) / t->tw;
+    int tail = OUTPUT_W % t->tw;
+    long long live = (long long)t->th * t->tw * OUTPUT_F * sizeof(int32_t);
+    unsigned long long cycles_per_pixel = (KERNEL_W * t->tc + MACS_PER_PE - 1) / MACS_PER_PE;
+    t->ifm_bytes = (long long)((t->th - 1) * STRIDE + KERNEL_H) * tile_w * t->tc;
+    t->weight_bytes = (long long)kernel_size * t->tc;
+    for (int c0 = 0; c0 < INPUT_C; c0 += t->tc) {
+        int nc = (INPUT_C - c0 < t->tc) ? INPUT_C - c0 : t->tc;
+        for (int ho0 = 0; ho0 < OUTPUT_H; ho0 += t->th) {
+            int num_rows = (OUTPUT_H - ho0 < t->th) ? OUTPUT_H - ho0 : t->th;
+            int rows_needed = (num_rows - 1) * STRIDE + KERNEL_H;
+            t->dma += segs * (sim_xfer_cycles((long long)rows_needed * tile_w * nc, 1) +
+                              OUTPUT_F * sim_xfer_cycles((long long)kernel_size * nc, 1));
+            int first = (c0 == 0), last = (c0 + t->tc >= INPUT_C);
+            t->dma += (unsigned long long)num_rows * (OUTPUT_W / t->tw) *
+                      sim_psum_xfer_cycles((long long)t->tw * OUTPUT_F, first, last, live);
+            if (tail) t->dma += num_rows * sim_psum_xfer_cycles((long long)tail * OUTPUT_F, first, last, live);
+            t->compute += OUTPUT_F * ((unsigned long long)OUTPUT_W * cycles_per_pixel * RS_FOLD +
+                                      segs * (KERNEL_H - 1)) * PE_COMPUTE_CYCLES;
+        }
+    }
+}
+
+// CONTROLLER: ROW STATIONARY
+
+void run_accelerator_rs() {
+    int num_passes = (INPUT_C + PARALLEL_CHANNELS - 1) / PARALLEL_CHANNELS;
+
+    for (int ho0 = 0; ho0 < OUTPUT_H; ho0 += RS_COLS) {
+        int num_rows = (OUTPUT_H - ho0 < RS_COLS) ? (OUTPUT_H - ho0) : RS_COLS;
+        for (int wo0 = 0; wo0 < OUTPUT_W; wo0 += SEG_W) {
+            int num_cols = (OUTPUT_W - wo0 < SEG_W) ? (OUTPUT_W - wo0) : SEG_W;
+            for (int p = 0; p < num_passes; p++) {
+                // Hàng IFM đứng yên trong PE cho mọi filter
+                dma_load_ifm_rows(ho0, num_rows, wo0, p);
+                for (int f = 0; f < OUTPUT_F; f++) {
+                    dma_load_weight_rows(f, p);
+                    run_pe_array(p, f, ho0, num_rows, wo0, num_cols);
+                }
+                // Đọc-sửa-ghi psum của nhóm hàng (mỗi hàng: num_cols x OUTPUT_F int32 liền nhau)
+                for (int j = 0; j < num_rows; j++) {
+                    sim_psum_update(((long long)(ho0 + j) * OUTPUT_W + wo0) * OUTPUT_F, num_cols * OUTPUT_F,
+                                    p == 0, p == num_passes - 1);
+                }
+            }
+        }
+    }
+}
+
+int main(int argc, char *argv[]) {
+    // Đọc 13 tham số + tính PARALLEL_CHANNELS (common/sim_core.h)
+    if (sim_parse_args(argc, argv, "") < 0) return -1;
+    if (PARALLEL_CHANNELS < 1) PARALLEL_CHANNELS = 1;
+    int kernel_size = KERNEL_H * KERNEL_W;
+
+    // Lưới PE: KERNEL_H hàng x RS_COLS cột
+    RS_COLS = NUM_PE / KERNEL_H;
+    RS_FOLD = 1;
+    if (RS_COLS < 1) {
+        RS_COLS = 1;
+        RS_FOLD = (KERNEL_H + NUM_PE - 1) / NUM_PE;
+    }
+
+    // Chọn số channel / pass, số hàng / nhóm và số cột / đoạn vừa BUFFER_SIZE_BYTES
+    if (sim_plan_tiling(RS_COLS, OUTPUT_W, 1, plan_model_rs) < 0) return -1;
+    RS_COLS = sim_plan.th;
+    SEG_W = sim_plan.tw;
+    TILE_W = (SEG_W - 1) * STRIDE + KERNEL_W;
+    MAX_ROWS = (RS_COLS - 1) * STRIDE + KERNEL_H;
+
+    // Cấp phát bộ nhớ động
+    buffer_ifm = (int8_t*)malloc(MAX_ROWS * TILE_W * PARALLEL_CHANNELS * sizeof(int8_t));
+    buffer_weight = (int8_t*)calloc(kernel_size * PARALLEL_CHANNELS, sizeof(int8_t));
+
+    if (!buffer_ifm || !buffer_weight) {
+        printf("Error: Malloc failed\n");
+        return -1;
+    }
+
+    // Chạy mô phỏng
+    sim_init();
+    // Psum cộng dồn dở: 1 nhóm hàng x 1 đoạn cột cho mọi filter
+    sim_psum_plan((long long)RS_COLS * SEG_W * OUTPUT_F * sizeof(int32_t));
+    // GLB (SIM_GLB=1): hàng kernel được load lại cho mọi filter của mọi nhóm hàng -> ưu tiên weight, phần còn lại cho IFM
+    glb_keep(DRAM_WEIGHT, (long long)KERNEL_H * KERNEL_W * INPUT_C * OUTPUT_F);
+    glb_keep(DRAM_IFM, (long long)INPUT_H * INPUT_W * INPUT_C);
+    dram_init();
+    run_accelerator_rs();
+    write_dram_to_file();
+    sim_report();
+    // Thống kê: số cột PE, số PE dùng, hàng IFM load từ DRAM, hàng IFM nhận qua multicast
+    int active_pe = (NUM_PE < KERNEL_H) ? NUM_PE : RS_COLS * KERNEL_H;
+    printf("RS_STATS,%d,%d,%llu,%llu\n", RS_COLS, active_pe, ifm_rows_loaded, ifm_rows_reused);
+
+    // Dọn dẹp
+    free(buffer_ifm);
+    free(buffer_weight);
+    cleanup();
+
+    return 0;
+}
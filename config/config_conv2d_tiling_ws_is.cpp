@@ -2,148 +2,56 @@
 #include <stdlib.h>
 #include <stdint.h>
 #include <string.h>
+#include "../common/sim_core.h"
 
-// --- CẤU HÌNH BÀI TOÁN ---
-// #define INPUT_H 112
-// #define INPUT_W 112
-// #define INPUT_C 32
-// #define KERNEL_H 3
-// #define KERNEL_W 3
-// #define OUTPUT_F 1 
-// #define OUTPUT_H 112
-// #define OUTPUT_W 112
-// #define STRIDE 1
-// #define PADDING 1
-int INPUT_H, INPUT_W, INPUT_C;
-int KERNEL_H, KERNEL_W;
-int OUTPUT_F, OUTPUT_H, OUTPUT_W;
-int STRIDE, PADDING;
-
-// --- CẤU HÌNH PHẦN CỨNG ---
-// #define NUM_PE 48               
-// #define MACS_PER_PE 3           
-// #define BUFFER_SIZE_BYTES 144   // 1152 bit = 144 bytes
-// #define PARALLEL_CHANNELS 16    // 16 channels song song
-int NUM_PE, MACS_PER_PE, BUFFER_SIZE_BYTES;
-int PARALLEL_CHANNELS;
-
-// --- CẤU HÌNH HIỆU NĂNG ---
-// #define SYSTEM_FREQ_MHZ 100.0   
-#define DRAM_BUS_WIDTH_BYTES 8  
-#define PE_COMPUTE_CYCLES 1     
-
-// Biến toàn cục đếm hiệu năng
-unsigned long long total_dma_cycles = 0;
-unsigned long long total_compute_cycles = 0;
-
-// --- MÔ PHỎNG BỘ NHỚ ---
-int8_t* ifm_dram;       
-int8_t* weight_dram;    
-int32_t* ofm_dram;      
-
+// --- BUFFER ON-CHIP ---
 // int8_t buffer_ifm[BUFFER_SIZE_BYTES];   
 // int8_t buffer_weight[BUFFER_SIZE_BYTES]; 
 int8_t* buffer_ifm;   
 int8_t* buffer_weight;
-
-void dram_init() {
-    ifm_dram = (int8_t*)malloc(INPUT_H * INPUT_W * INPUT_C);
-    // Load IFM
-    FILE* f_ifm = fopen("../params/ifm.txt", "r");
-    if(f_ifm) {
-        char line[64];
-        
-        for (int h = 0; h < INPUT_H; h++) {
-            for (int w = 0; w < INPUT_W; w++) {
-                for (int c = 0; c < INPUT_C; c++) {
-                    
-                    if (fgets(line, 64, f_ifm)) {
-                        // Chuyển từ chuỗi sang số nguyên 
-                        int val = atoi(line);
-                        // Xử lý số nguyên có dấu 8-bit 
-                        if (val > 0x7F) {
-                            val -= 0x100;
-                        }
-                        // Công thức: index = h * (W * C) + w * C + c
-                        // [h, w, c]
-                        int idx = h * (INPUT_W * INPUT_C) + w * INPUT_C + c;
-                        // Gán vào DRAM 
-                        ifm_dram[idx] = (int8_t)val;
-                    }
-                }
-            }
-        }
-        fclose(f_ifm);
-    } else {
-        printf("Error: Could not open ../params/ifm.txt\n");
-        memset(ifm_dram, 1, INPUT_H * INPUT_W * INPUT_C); 
-    }
-
-    weight_dram = (int8_t*)calloc(KERNEL_H * KERNEL_W * INPUT_C * OUTPUT_F, 1);
-    FILE* f_w = fopen("../params/weights.txt", "r");
-    if(f_w) {
-        char line[64];
-        for(int f=0; f<OUTPUT_F; f++)
-            for(int h=0; h<KERNEL_H; h++)
-                for(int w=0; w<KERNEL_W; w++)
-                    for(int c=0; c<INPUT_C; c++)
-                        if(fgets(line, 64, f_w)) {
-                             int val = atoi(line);
-                             if (val > 0x7F) val -= 0x100;
-                             int idx = h*(KERNEL_W*INPUT_C*OUTPUT_F) + w*(INPUT_C*OUTPUT_F) + c*OUTPUT_F + f;
-                             weight_dram[idx] = (int8_t)val;
-                        }
-        fclose(f_w);
-    }
-
-    ofm_dram = (int32_t*)calloc(OUTPUT_H * OUTPUT_W * OUTPUT_F, sizeof(int32_t));
-}
+int FILTER_GROUP;       // Số filter có weight nằm trong buffer cùng lúc (sim_plan.tf)
+int W_BANK;             // Kích thước bank weight của 1 filter: PARALLEL_CHANNELS x KERNEL_H x KERNEL_W
+
+// --- LINE BUFFER (tùy chọn, tham số thứ 14 = 1) ---
+// Giữ KERNEL_H hàng IFM (đã pad) on-chip cho mỗi pass: KERNEL_H-1 hàng dùng lại
+// từ hàng output trước + 1 hàng mới (STRIDE hàng nếu STRIDE > 1).
+// Cửa sổ KERNEL_H x KERNEL_W được lấy trực tiếp từ line buffer, không qua DMA.
+// Line buffer là SRAM riêng (linebuf_sram, LINEBUF_STATS), không tính vào BUFFER_SIZE_BYTES.
+// Layout: [slot][cột][channel], hàng pad pr nằm ở slot pr % KERNEL_H
+int LINE_BUFFER;
+int LB_W;                   // Số cột của 1 hàng (kể cả padding): (OUTPUT_W-1)*STRIDE + KERNEL_W
+int8_t* line_buffer;
+unsigned long long lb_ifm_dma_cycles = 0;      // DMA IFM thực tế ở chế độ line buffer
+unsigned long long sliding_ifm_dma_cycles = 0; // DMA IFM nếu dùng sliding window (sim_xfer_cycles, để so sánh)
 
 // CÁC HÀM DMA (Weight, IFM Init, IFM Shift)
 
-// Load Weight (Weight Stationary - Chỉ chạy đầu Pass)
-void dma_load_weights(int pass_idx) {
+// Load Weight (Weight Stationary - Chỉ chạy đầu Pass / đầu nhóm filter)
+// Load weight của nhóm filter [f0, f0 + num_f), filter f nằm ở bank buffer_weight + (f - f0) * W_BANK
+// Mỗi filter 1 descriptor 2D, bank layout [kh][kw][channel] như buffer IFM
+void dma_load_weights(int pass_idx, int f0, int num_f) {
     int channel_start = pass_idx * PARALLEL_CHANNELS;
-    int buffer_ptr = 0;
-    for (int i = 0; i < PARALLEL_CHANNELS; i++) {
-        int current_c = channel_start + i;
-        if (current_c >= INPUT_C) break;
-        for (int kh = 0; kh < KERNEL_H; kh++) {
-            for (int kw = 0; kw < KERNEL_W; kw++) {
-                int w_idx = kh*(KERNEL_W*INPUT_C*OUTPUT_F) + kw*(INPUT_C*OUTPUT_F) + current_c*OUTPUT_F;
-                buffer_weight[buffer_ptr++] = weight_dram[w_idx];
-            }
-        }
+    int nc = (INPUT_C - channel_start < PARALLEL_CHANNELS) ? INPUT_C - channel_start : PARALLEL_CHANNELS;
+    int bank_bytes = nc * KERNEL_H * KERNEL_W;
+    for (int f = f0; f < f0 + num_f; f++) {
+        sim_desc_weight(buffer_weight + (f - f0) * W_BANK, f, channel_start, nc, nc);
+        sram_touch(&weight_sram, (long long)(f - f0) * W_BANK, bank_bytes);
     }
-    // Latency: Load 144 bytes
-    total_dma_cycles += (buffer_ptr + DRAM_BUS_WIDTH_BYTES - 1) / DRAM_BUS_WIDTH_BYTES;
+    // Latency: Load weight của pass x num_f
+    sim_dma_load(DMA_CH_WEIGHT, bank_bytes * num_f, &weight_buf, NULL);
 }
 
-// IFM INIT: Load toàn bộ 3x3 block (Chạy tại điểm đầu tiên của mỗi hàng: wo=0)
-// Tương ứng với "Khung màu Đỏ"
+// IFM INIT: Load toàn bộ cửa sổ KERNEL_H x KERNEL_W (Chạy tại điểm đầu tiên của mỗi hàng: wo=0)
+// Tương ứng với "Khung màu Đỏ". Buffer layout [kh][kw][channel], 1 descriptor 3D
 void dma_load_ifm_init(int ho, int pass_idx) {
     int channel_start = pass_idx * PARALLEL_CHANNELS;
-    int buffer_ptr = 0;
-
-    for (int i = 0; i < PARALLEL_CHANNELS; i++) {
-        int current_c = channel_start + i;
-        if (current_c >= INPUT_C) break;
-
-        for (int kh = 0; kh < KERNEL_H; kh++) {
-            for (int kw = 0; kw < KERNEL_W; kw++) {
-                int hi = ho * STRIDE + kh - PADDING;
-                int wi = 0 * STRIDE + kw - PADDING; // wo = 0
-                
-                int8_t val = 0;
-                if (hi >= 0 && hi < INPUT_H && wi >= 0 && wi < INPUT_W) {
-                    val = ifm_dram[hi * (INPUT_W * INPUT_C) + wi * INPUT_C + current_c];
-                }
-                buffer_ifm[buffer_ptr++] = val;
-            }
-        }
-    }
-    // Latency: Load 144 bytes (Full Load)
-    total_dma_cycles += (buffer_ptr + DRAM_BUS_WIDTH_BYTES - 1) / DRAM_BUS_WIDTH_BYTES;
+    int nc = (INPUT_C - channel_start < PARALLEL_CHANNELS) ? INPUT_C - channel_start : PARALLEL_CHANNELS;
+    int bytes = nc * KERNEL_H * KERNEL_W;
+    sim_desc_ifm(buffer_ifm, ho * STRIDE - PADDING, 0 * STRIDE - PADDING, channel_start, nc,
+                 KERNEL_H, KERNEL_W, (long long)KERNEL_W * nc, nc);
+    // Latency: Full Load (byte padding cũng tính)
+    sram_touch(&ifm_sram, 0, bytes);
+    sim_dma_load(DMA_CH_IFM, bytes, &ifm_buf, NULL);
 }
 
 // IFM SHIFT & LOAD: Dịch buffer và chỉ load cột mới
@@ -187,7 +95,7 @@ void dma_load_ifm_init(int ho, int pass_idx) {
             
 //             int8_t val = 0;
 //             if (hi >= 0 && hi < INPUT_H && wi >= 0 && wi < INPUT_W) {
-//                 val = ifm_dram[hi * (INPUT_W * INPUT_C) + wi * INPUT_C + current_c];
+//                 val = ifm_read(hi * (INPUT_W * INPUT_C) + wi * INPUT_C + current_c);
 //             }
             
 //             // Ghi vào vị trí cột 2 (Index 2, 5, 8)
@@ -201,65 +109,114 @@ void dma_load_ifm_init(int ho, int pass_idx) {
 // }
 void dma_shift_and_load_col(int ho, int wo, int pass_idx) {
     int channel_start = pass_idx * PARALLEL_CHANNELS;
-    int kernel_size = KERNEL_H * KERNEL_W;
-
-    // SHIFT PHASE: Dịch chuyển dữ liệu sang trái
-    for (int i = 0; i < PARALLEL_CHANNELS; i++) {
-        int base = i * kernel_size; 
-        
-        for (int kh = 0; kh < KERNEL_H; kh++) {
-            // Duyệt đến cột kế cuối (KERNEL_W - 2)
-            for (int kw = 0; kw < KERNEL_W - 1; kw++) {
-                int dest = base + (kh * KERNEL_W) + kw;       // Vị trí nhận
-                int src  = base + (kh * KERNEL_W) + (kw + 1); // Vị trí nguồn (bên phải nó)
-                buffer_ifm[dest] = buffer_ifm[src];
-            }
-        }
+    int nc = (INPUT_C - channel_start < PARALLEL_CHANNELS) ? INPUT_C - channel_start : PARALLEL_CHANNELS;
+    int new_cols = (STRIDE < KERNEL_W) ? STRIDE : KERNEL_W;
+    int keep = KERNEL_W - new_cols;
+    int row = KERNEL_W * nc;
+
+    // SHIFT PHASE: mỗi hàng kernel dời new_cols cột sang trái
+    for (int kh = 0; kh < KERNEL_H; kh++) {
+        memmove(buffer_ifm + kh * row, buffer_ifm + kh * row + new_cols * nc, keep * nc);
     }
 
-    // LOAD PHASE: Chỉ load cột mới nhất bên phải (cột cuối cùng của kernel)
-    int bytes_loaded = 0;
-    for (int i = 0; i < PARALLEL_CHANNELS; i++) {
-        int current_c = channel_start + i;
-        if (current_c >= INPUT_C) break;
-        int base = i * kernel_size;
+    // LOAD PHASE: Chỉ load new_cols cột mới bên phải (1 descriptor 3D)
+    sim_desc_ifm(buffer_ifm + keep * nc, ho * STRIDE - PADDING, wo * STRIDE + keep - PADDING, channel_start, nc,
+                 KERNEL_H, new_cols, row, nc);
+    for (int kh = 0; kh < KERNEL_H; kh++) sram_touch(&ifm_sram, kh * row + keep * nc, new_cols * nc);
 
-        // Tính cột mới: Lấy rìa phải của window (KERNEL_W - 1)
-        int wi = wo * STRIDE + (KERNEL_W - 1) - PADDING;
+    // Latency
+    sim_dma_load(DMA_CH_IFM, nc * KERNEL_H * new_cols, &ifm_buf, NULL);
+}
 
-        for (int kh = 0; kh < KERNEL_H; kh++) { 
-            int hi = ho * STRIDE + kh - PADDING;
-            
-            int8_t val = 0;
-            if (hi >= 0 && hi < INPUT_H && wi >= 0 && wi < INPUT_W) {
-                val = ifm_dram[hi * (INPUT_W * INPUT_C) + wi * INPUT_C + current_c];
-            }
-            
-            // Ghi vào cột cuối cùng của hàng hiện tại
-            int idx = base + (kh * KERNEL_W) + (KERNEL_W - 1);
-            buffer_ifm[idx] = val;
-            bytes_loaded++;
-        }
+// LINE BUFFER: Load các hàng pad [pr_start, pr_start + count) của 1 pass vào line buffer
+// Mỗi hàng 1 descriptor 2D (slot pr % KERNEL_H không liền nhau khi quay vòng)
+void dma_load_line_rows(int pr_start, int count, int pass_idx) {
+    int channel_start = pass_idx * PARALLEL_CHANNELS;
+    int nc = (INPUT_C - channel_start < PARALLEL_CHANNELS) ? INPUT_C - channel_start : PARALLEL_CHANNELS;
+    for (int r = 0; r < count; r++) {
+        int pr = pr_start + r;
+        int8_t* row = line_buffer + (pr % KERNEL_H) * LB_W * PARALLEL_CHANNELS;
+        sim_desc_ifm(row, pr - PADDING, -PADDING, channel_start, nc, 1, LB_W, 0, PARALLEL_CHANNELS);
+        sram_touch(&linebuf_sram, (long long)(pr % KERNEL_H) * LB_W * PARALLEL_CHANNELS, LB_W * PARALLEL_CHANNELS);
     }
+    lb_ifm_dma_cycles += sim_dma_load(DMA_CH_IFM, count * LB_W * nc, &ifm_buf, NULL);
+}
 
-    // Latency
-    total_dma_cycles += (bytes_loaded + DRAM_BUS_WIDTH_BYTES - 1) / DRAM_BUS_WIDTH_BYTES;
+// LINE BUFFER: Lấy cửa sổ của pixel (ho, wo) từ line buffer vào buffer_ifm (on-chip, 0 chu kỳ DMA)
+// Giữ layout [kh][kw][channel] như dma_load_ifm_init để run_pe_array không đổi
+void lb_fill_window(int ho, int wo, int num_c) {
+    for (int kh = 0; kh < KERNEL_H; kh++) {
+        int pr = ho * STRIDE + kh;
+        const int8_t* row = line_buffer + (pr % KERNEL_H) * LB_W * PARALLEL_CHANNELS;
+        for (int kw = 0; kw < KERNEL_W; kw++) {
+            memcpy(buffer_ifm + (kh * KERNEL_W + kw) * num_c, row + (wo * STRIDE + kw) * PARALLEL_CHANNELS, num_c);
+        }
+    }
 }
 
 // COMPUTE ENGINE
 
-int32_t run_pe_array() {
-    int32_t partial_sum = 0;
-    for (int pe_id = 0; pe_id < NUM_PE; pe_id++) {
-        int base_idx = pe_id * MACS_PER_PE; 
-        int32_t pe_acc = 0; 
-        for (int k = 0; k < MACS_PER_PE; k++) {
-            pe_acc += (int32_t)buffer_ifm[base_idx + k] * (int32_t)buffer_weight[base_idx + k];
+// Tính cho filter ở bank slot của nhóm hiện tại: IFM dùng chung, Weight lấy từ bank slot
+// pass_idx: pass hiện tại, num_c: số channel thật của pass (pass cuối có thể ít hơn PARALLEL_CHANNELS)
+int32_t run_pe_array(int pass_idx, int slot, int num_c) {
+    // num_c x KERNEL_H x KERNEL_W phép MAC được gom thành 1 tích vô hướng int8 (kernel SIMD)
+    int n = num_c * KERNEL_H * KERNEL_W;
+    int32_t partial_sum = pe_dot_i8(buffer_ifm, buffer_weight + slot * W_BANK, n);
+    // Năng lượng: n MAC, đọc IFM + Weight từ buffer
+    sim_pe_energy(n, 2 * n);
+    sram_touch(&ifm_sram, 0, n);
+    sram_touch(&weight_sram, (long long)slot * W_BANK, n);
+    // Lượt đầu của pass mới: fill + drain pipeline (SIM_PE_MODEL, common/pe_timing.h)
+    sim_compute(&pe_array, sim_read_cycles(PE_COMPUTE_CYCLES) + pe_timing_ramp(pass_idx), &ifm_buf, &weight_buf);
+    // Utilization: n MAC trải phẳng từ PE 0 trong 1 lượt
+    pe_util_fill(pass_idx, n, PE_COMPUTE_CYCLES);
+    return partial_sum;
+}
+
+// MÔ HÌNH TILE (common/tiling_planner.h)
+// Buffer IFM: cửa sổ tc x KERNEL_H x KERNEL_W; buffer Weight: tf bank như vậy.
+// Mỗi pass, mỗi nhóm tf filter: load weight 1 lần, rồi quét lại IFM của cả ảnh
+// (sliding window: mỗi hàng 1 lần load đủ + OUTPUT_W-1 lần load new_cols cột mới; line buffer: các hàng mới,
+// 1 descriptor / hàng nằm trong ảnh); mỗi pixel 1 lần đọc-sửa-ghi psum của nhóm
+// (tập cộng dồn dở: cả ảnh x OUTPUT_F filter, pass là vòng ngoài cùng)
+
+// Số descriptor khi load các hàng pad [pr_start, pr_start + count): hàng ngoài ảnh chỉ ghi 0
+int lb_row_descs(int pr_start, int count) {
+    int n = 0;
+    for (int pr = pr_start; pr < pr_start + count; pr++) {
+        if (pr - PADDING >= 0 && pr - PADDING < INPUT_H) n++;
+    }
+    return (n > 0) ? n : 1;
+}
+
+void plan_model_wsis(tile_plan* t) {
+    int kernel_size = KERNEL_H * KERNEL_W;
+    int new_rows = (STRIDE < KERNEL_H) ? STRIDE : KERNEL_H;
+    int new_cols = (STRIDE < KERNEL_W) ? STRIDE : KERNEL_W;
+    unsigned long long pixels = (unsigned long long)OUTPUT_H * OUTPUT_W;
+    long long live = (long long)pixels * OUTPUT_F * sizeof(int32_t);
+    t->ifm_bytes = (long long)t->tc * kernel_size;
+    t->weight_bytes = (long long)t->tc * kernel_size * t->tf;
+    for (int c0 = 0; c0 < INPUT_C; c0 += t->tc) {
+        int nc = (INPUT_C - c0 < t->tc) ? INPUT_C - c0 : t->tc;
+        unsigned long long ifm;
+        if (LINE_BUFFER) {
+            ifm = sim_xfer_cycles((long long)KERNEL_H * LB_W * nc, lb_row_descs(0, KERNEL_H));
+            for (int ho = 1; ho < OUTPUT_H; ho++) {
+                ifm += sim_xfer_cycles((long long)new_rows * LB_W * nc,
+                                       lb_row_descs(ho * STRIDE + KERNEL_H - new_rows, new_rows));
+            }
+        } else {
+            ifm = OUTPUT_H * (sim_xfer_cycles((long long)nc * kernel_size, 1) +
+                              (OUTPUT_W - 1) * sim_xfer_cycles((long long)nc * KERNEL_H * new_cols, 1));
         }
-        partial_sum += pe_acc;
+        for (int f0 = 0; f0 < OUTPUT_F; f0 += t->tf) {
+            int nf = (OUTPUT_F - f0 < t->tf) ? OUTPUT_F - f0 : t->tf;
+            t->dma += sim_xfer_cycles((long long)nc * kernel_size * nf, nf) + ifm;
+            t->dma += pixels * sim_psum_xfer_cycles(nf, c0 == 0, c0 + t->tc >= INPUT_C, live);
+        }
+        t->compute += pixels * OUTPUT_F * PE_COMPUTE_CYCLES;
     }
-    total_compute_cycles += PE_COMPUTE_CYCLES;
-    return partial_sum;
 }
 
 // CONTROLLER: WS + SLIDING WINDOW
@@ -270,36 +227,48 @@ void run_accelerator_optimized() {
 
     // Loop Pass (Weight Stationary)
     for (int p = 0; p < num_passes; p++) {
-        // printf("Pass %d/%d: Loading Weights...\n", p+1, num_passes);
-        dma_load_weights(p);
+        int num_c = (INPUT_C - p * PARALLEL_CHANNELS < PARALLEL_CHANNELS) ? INPUT_C - p * PARALLEL_CHANNELS : PARALLEL_CHANNELS;
 
-        // Loop Height
-        for (int ho = 0; ho < OUTPUT_H; ho++) {
-            
-            // --- PIXEL ĐẦU TIÊN CỦA HÀNG (wo=0) ---
-            // Phải load đầy đủ (Warm-up buffer)
-            dma_load_ifm_init(ho, p);
-            
-            // Tính toán
-            int32_t res = run_pe_array();
-            ofm_dram[ho * OUTPUT_W + 0] += res;
-
-            // --- CÁC PIXEL CÒN LẠI (wo > 0) ---
-            // Dùng kỹ thuật Sliding Window
-            for (int wo = 1; wo < OUTPUT_W; wo++) {
-                
-                // Shift trái và load cột mới
-                dma_shift_and_load_col(ho, wo, p);
-
-                // Tính toán
-                int32_t partial_result = run_pe_array();
-                ofm_dram[ho * OUTPUT_W + wo] += partial_result;
+        // Buffer Weight chỉ chứa FILTER_GROUP filter -> chia filter thành nhóm
+        for (int f0 = 0; f0 < OUTPUT_F; f0 += FILTER_GROUP) {
+            int num_f = (OUTPUT_F - f0 < FILTER_GROUP) ? OUTPUT_F - f0 : FILTER_GROUP;
+            // printf("Pass %d/%d: Loading Weights...\n", p+1, num_passes);
+            dma_load_weights(p, f0, num_f);
+
+            // Loop Height
+            for (int ho = 0; ho < OUTPUT_H; ho++) {
+
+                // --- PIXEL ĐẦU TIÊN CỦA HÀNG (wo=0) ---
+                // Phải load đầy đủ (Warm-up buffer)
+                dma_load_ifm_init(ho, p);
+
+                // Tính toán (cửa sổ IFM dùng chung cho mọi filter của nhóm)
+                for (int f = f0; f < f0 + num_f; f++) {
+                    int32_t res = run_pe_array(p, f - f0, num_c);
+                    ofm_dram[(ho * OUTPUT_W + 0) * OUTPUT_F + f] += res;
+                }
+                sim_psum_update((ho * OUTPUT_W + 0) * OUTPUT_F + f0, num_f, p == 0, p == num_passes - 1);
+
+                // --- CÁC PIXEL CÒN LẠI (wo > 0) ---
+                // Dùng kỹ thuật Sliding Window
+                for (int wo = 1; wo < OUTPUT_W; wo++) {
+
+                    // Shift trái và load cột mới
+                    dma_shift_and_load_col(ho, wo, p);
+
+                    // Tính toán
+                    for (int f = f0; f < f0 + num_f; f++) {
+                        int32_t partial_result = run_pe_array(p, f - f0, num_c);
+                        ofm_dram[(ho * OUTPUT_W + wo) * OUTPUT_F + f] += partial_result;
+                    }
+                    // Đọc-sửa-ghi psum của nhóm filter tại pixel (num_f int32 liền nhau)
+                    sim_psum_update((ho * OUTPUT_W + wo) * OUTPUT_F + f0, num_f, p == 0, p == num_passes - 1);
+                }
             }
         }
     }
 
     // Report
-    unsigned long long total_cycles = total_dma_cycles + total_compute_cycles;
     // double total_time_ms = (double)total_cycles / (SYSTEM_FREQ_MHZ * 1000.0);
     // printf("\n--- PERFORMANCE REPORT (OPTIMIZED) ---\n");
     // printf("Total Cycles: %llu\n", total_cycles);
@@ -309,14 +278,45 @@ void run_accelerator_optimized() {
     // printf("--------------------------------------\n");
 }
 
-void write_dram_to_file() {
-    FILE* f = fopen("../ofm/ofm.txt", "w");
-    if (!f) return;
-    for(int i=0; i<OUTPUT_H*OUTPUT_W; i++) fprintf(f, "%d\n", ofm_dram[i]);
-    fclose(f);
-}
+// CONTROLLER: WS + LINE BUFFER
+// Hàng output đầu tiên load đủ KERNEL_H hàng, các hàng sau chỉ load STRIDE hàng mới
+void run_accelerator_line_buffer() {
+    int num_passes = (INPUT_C + PARALLEL_CHANNELS - 1) / PARALLEL_CHANNELS;
+    int new_rows = (STRIDE < KERNEL_H) ? STRIDE : KERNEL_H;
+
+    for (int p = 0; p < num_passes; p++) {
+        // Chi phí IFM của sliding window cho pass này (init + mỗi pixel load STRIDE cột mới)
+        int real_c = INPUT_C - p * PARALLEL_CHANNELS;
+        if (real_c > PARALLEL_CHANNELS) real_c = PARALLEL_CHANNELS;
+        int new_cols = (STRIDE < KERNEL_W) ? STRIDE : KERNEL_W;
+        unsigned long long init_cycles = sim_xfer_cycles((long long)real_c * KERNEL_H * KERNEL_W, 1);
+        unsigned long long shift_cycles = sim_xfer_cycles((long long)real_c * KERNEL_H * new_cols, 1);
+
+        // Mỗi nhóm filter quét lại cả ảnh (sliding window cũng vậy)
+        for (int f0 = 0; f0 < OUTPUT_F; f0 += FILTER_GROUP) {
+            int num_f = (OUTPUT_F - f0 < FILTER_GROUP) ? OUTPUT_F - f0 : FILTER_GROUP;
+            dma_load_weights(p, f0, num_f);
+            sliding_ifm_dma_cycles += (unsigned long long)OUTPUT_H * (init_cycles + (OUTPUT_W - 1) * shift_cycles);
+
+            for (int ho = 0; ho < OUTPUT_H; ho++) {
+                if (ho == 0) {
+                    dma_load_line_rows(0, KERNEL_H, p);
+                } else {
+                    dma_load_line_rows(ho * STRIDE + KERNEL_H - new_rows, new_rows, p);
+                }
 
-void cleanup() { free(ifm_dram); free(weight_dram); free(ofm_dram); }
+                for (int wo = 0; wo < OUTPUT_W; wo++) {
+                    lb_fill_window(ho, wo, real_c);
+                    for (int f = f0; f < f0 + num_f; f++) {
+                        int32_t partial_result = run_pe_array(p, f - f0, real_c);
+                        ofm_dram[(ho * OUTPUT_W + wo) * OUTPUT_F + f] += partial_result;
+                    }
+                    sim_psum_update((ho * OUTPUT_W + wo) * OUTPUT_F + f0, num_f, p == 0, p == num_passes - 1);
+                }
+            }
+        }
+    }
+}
 
 // int main() {
 //     dram_init();
@@ -326,55 +326,65 @@ void cleanup() { free(ifm_dram); free(weight_dram); free(ofm_dram); }
 //     return 0;
 // }
 int main(int argc, char *argv[]) {
-    // Kiểm tra tham số (13 số + 1 tên file = 14)
-    if (argc < 14) {
-        printf("Usage: %s IH IW IC KH KW OF OH OW S P NPE MAC BUF\n", argv[0]);
-        return -1;
-    }
-
-    // Gán giá trị
-    INPUT_H = atoi(argv[1]);
-    INPUT_W = atoi(argv[2]);
-    INPUT_C = atoi(argv[3]);
-    KERNEL_H = atoi(argv[4]);
-    KERNEL_W = atoi(argv[5]);
-    OUTPUT_F = atoi(argv[6]);
-    OUTPUT_H = atoi(argv[7]);
-    OUTPUT_W = atoi(argv[8]);
-    STRIDE = atoi(argv[9]);
-    PADDING = atoi(argv[10]);
-    NUM_PE = atoi(argv[11]);
-    MACS_PER_PE = atoi(argv[12]);
-    BUFFER_SIZE_BYTES = atoi(argv[13]);
-
-    // Tự động tính PARALLEL_CHANNELS
-    // Logic: Tổng resource / kích thước 1 kernel
-    int kernel_size = KERNEL_H * KERNEL_W;
-    if (kernel_size > 0) {
-        PARALLEL_CHANNELS = (NUM_PE * MACS_PER_PE) / kernel_size;
-    } else {
-        PARALLEL_CHANNELS = 1;
-    }
+    // Đọc 13 tham số + tính PARALLEL_CHANNELS (common/sim_core.h)
+    int extra = sim_parse_args(argc, argv, " [LINE_BUFFER]");
+    if (extra < 0) return -1;
+    // Tham số tùy chọn: 1 = IFM dùng line buffer, 0 (mặc định) = sliding window
+    LINE_BUFFER = (argc > extra) ? atoi(argv[extra]) : 0;
 
     // printf("--- Configuration ---\n");
     // printf("Auto-calculated PARALLEL_CHANNELS: %d\n", PARALLEL_CHANNELS);
     // printf("Buffer Size: %d bytes\n", BUFFER_SIZE_BYTES);
 
-    // Cấp phát bộ nhớ động
+    // Chọn số channel / pass và số filter / nhóm vừa BUFFER_SIZE_BYTES
+    LB_W = (OUTPUT_W - 1) * STRIDE + KERNEL_W;
+    if (sim_plan_tiling(1, 1, OUTPUT_F, plan_model_wsis) < 0) return -1;
+    FILTER_GROUP = sim_plan.tf;
+    W_BANK = PARALLEL_CHANNELS * KERNEL_H * KERNEL_W;
+
+    // Cấp phát bộ nhớ động (Weight: FILTER_GROUP bank, 1 bank / filter)
     buffer_ifm = (int8_t*)malloc(BUFFER_SIZE_BYTES * sizeof(int8_t));
-    buffer_weight = (int8_t*)malloc(BUFFER_SIZE_BYTES * sizeof(int8_t));
+    buffer_weight = (int8_t*)calloc(BUFFER_SIZE_BYTES, sizeof(int8_t));
 
     if (!buffer_ifm || !buffer_weight) {
         printf("Error: Malloc failed\n");
         return -1;
     }
 
+    // Line buffer: KERNEL_H hàng x LB_W cột x PARALLEL_CHANNELS
+    int lb_bytes = 0;
+    if (LINE_BUFFER) {
+        lb_bytes = KERNEL_H * LB_W * PARALLEL_CHANNELS;
+        line_buffer = (int8_t*)calloc(lb_bytes, sizeof(int8_t));
+        if (!line_buffer) {
+            printf("Error: Malloc failed\n");
+            return -1;
+        }
+    }
+
     // Chạy mô phỏng
+    sim_init();
+    // Psum cộng dồn dở: cả OFM, mọi filter (pass là vòng ngoài cùng, mọi nhóm filter chờ pass sau)
+    sim_psum_plan((long long)OUTPUT_H * OUTPUT_W * OUTPUT_F * sizeof(int32_t));
+    // GLB (SIM_GLB=1): weight chỉ load 1 lần / pass, hàng IFM được quét lại mỗi nhóm filter -> ưu tiên IFM
+    glb_keep(DRAM_IFM, (long long)INPUT_H * INPUT_W * INPUT_C);
+    glb_keep(DRAM_WEIGHT, (long long)KERNEL_H * KERNEL_W * INPUT_C * OUTPUT_F);
     dram_init();
-    run_accelerator_optimized();
+    if (LINE_BUFFER) run_accelerator_line_buffer();
+    else run_accelerator_optimized();
     write_dram_to_file();
-    unsigned long long total = total_dma_cycles + total_compute_cycles;
-    printf("SURVEY_RESULT,%llu,%llu,%llu\n", total_dma_cycles, total_compute_cycles, total);
+    sim_report();
+    if (LINE_BUFFER) {
+        // Byte SRAM thêm cho line buffer, chu kỳ DMA IFM tiết kiệm so với sliding window.
+        // Mốc sliding window là ước lượng sim_xfer_cycles, chỉ so được khi DMA đo cũng theo mô hình đó
+        if (sim_dma_analytic()) {
+            long long saved = (long long)sliding_ifm_dma_cycles - (long long)lb_ifm_dma_cycles;
+            printf("LINEBUF_STATS,%d,%lld\n", lb_bytes, saved);
+        } else {
+            printf("LINEBUF_STATS,%d\n", lb_bytes);
+        }
+        free(line_buffer);
+    }
     // ---------------------
     // Dọn dẹp
     free(buffer_ifm);
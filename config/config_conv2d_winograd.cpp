@@ -0,0 +1,262 @@
+// ./wino 112 112 32 3 3 1 112 112 1 1 48 3 144 2
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "../common/sim_core.h"
+#include "../common/winograd.h"
+
+// --- CẤU HÌNH WINOGRAD ---
+// WINO_M = 2 -> F(2x2,3x3), tile input 4x4 ; WINO_M = 4 -> F(4x4,3x3), tile input 6x6
+int WINO_M;
+int WINO_ALPHA;
+int WINO_U_BYTES;               // Số byte / phần tử weight đã biến đổi (F2: 12 bit -> 2, F4: 18 bit -> 4)
+const winograd_cfg* wino;
+int FILTER_GROUP;               // Số filter có U nằm trong buffer cùng lúc (sim_plan.tf)
+
+// --- CẤU HÌNH HIỆU NĂNG ---
+#define WINO_TRANSFORM_CYCLES 1    // Khối biến đổi input / output (chỉ có cộng/trừ/dịch)
+
+// Biến toàn cục đếm hiệu năng
+unsigned long long total_wino_macs = 0;     // Số MAC thực tế (miền Winograd)
+unsigned long long total_ifm_bytes = 0;
+unsigned long long total_weight_bytes = 0;
+
+// --- BUFFER ON-CHIP ---
+int8_t* buffer_ifm;     // Tile input alpha x alpha x PARALLEL_CHANNELS
+int64_t* buffer_u;      // Weight đã biến đổi U cho các channel của pass, 1 bank / filter của nhóm
+int64_t* u_dram;        // U[f][c] của toàn bộ filter/channel (biến đổi offline, nằm ở DRAM)
+
+// BIẾN ĐỔI WEIGHT OFFLINE (không tính cycle, giống việc weight được chuẩn bị sẵn)
+// u_dram[f][c][alpha*alpha] = G_s g G_s^T
+void weight_transform_offline() {
+    int aa = WINO_ALPHA * WINO_ALPHA;
+    u_dram = (int64_t*)malloc((size_t)OUTPUT_F * INPUT_C * aa * sizeof(int64_t));
+    for (int f = 0; f < OUTPUT_F; f++) {
+        for (int c = 0; c < INPUT_C; c++) {
+            int32_t g[9];
+            for (int kh = 0; kh < 3; kh++)
+                for (int kw = 0; kw < 3; kw++)
+                    g[kh * 3 + kw] = weight_dram[kh*(KERNEL_W*INPUT_C*OUTPUT_F) + kw*(INPUT_C*OUTPUT_F) + c*OUTPUT_F + f];
+            winograd_transform_weight(wino, g, u_dram + ((size_t)f * INPUT_C + c) * aa);
+        }
+    }
+}
+
+// CÁC HÀM DMA
+
+// Load U (alpha x alpha / channel) của các channel trong pass, cho nhóm filter [f0, f0 + num_f)
+// U nằm liền nhau theo [f][c] ở DRAM (WINO_U_BYTES byte / phần tử) -> 1 descriptor 2D:
+// num_f đoạn liền nhau nc x alpha^2 phần tử, bước INPUT_C x alpha^2 phần tử
+void dma_load_weights_wino(int pass_idx, int f0, int num_f) {
+    int aa = WINO_ALPHA * WINO_ALPHA;
+    int channel_start = pass_idx * PARALLEL_CHANNELS;
+    int nc = (INPUT_C - channel_start < PARALLEL_CHANNELS) ? INPUT_C - channel_start : PARALLEL_CHANNELS;
+    for (int f = f0; f < f0 + num_f; f++) {
+        int64_t* bank = buffer_u + (size_t)(f - f0) * PARALLEL_CHANNELS * aa;
+        long long src = ((long long)f * INPUT_C + channel_start) * aa;
+        memcpy(bank, u_dram + src, (size_t)nc * aa * sizeof(int64_t));
+        glb_read(DRAM_WEIGHT, src * WINO_U_BYTES, nc * aa * WINO_U_BYTES);
+    }
+    dma_desc_note();
+    int bytes = num_f * nc * aa * WINO_U_BYTES;
+    total_weight_bytes += bytes;
+    sram_touch(&weight_sram, 0, bytes);
+    sim_dma_load(DMA_CH_WEIGHT, bytes, &weight_buf, NULL);
+}
+
+// Load tile input alpha x alpha (gồm cả phần chồng lấn 2 hàng/cột với tile bên cạnh)
+// Layout [y][x][channel], 1 descriptor 3D
+void dma_load_ifm_tile(int th, int tw, int pass_idx) {
+    int a = WINO_ALPHA;
+    int channel_start = pass_idx * PARALLEL_CHANNELS;
+    int nc = (INPUT_C - channel_start < PARALLEL_CHANNELS) ? INPUT_C - channel_start : PARALLEL_CHANNELS;
+    int bytes = nc * a * a;
+    sim_desc_ifm(buffer_ifm, th * WINO_M - PADDING, tw * WINO_M - PADDING, channel_start, nc, a, a,
+                 (long long)a * nc, nc);
+    total_ifm_bytes += bytes;
+    sram_touch(&ifm_sram, 0, bytes);
+    sim_dma_load(DMA_CH_IFM, bytes, &ifm_buf, NULL);
+}
+
+// COMPUTE ENGINE
+
+// Biến đổi input + nhân từng phần tử, cộng dồn vào accumulator M[f] (nằm trên chip)
+// Tile input chỉ biến đổi 1 lần rồi dùng lại cho tất cả filter của nhóm [f0, f0 + num_f)
+void run_pe_array_wino(int pass_idx, int64_t* M, int f0, int num_f) {
+    int a = WINO_ALPHA;
+    int aa = a * a;
+    int channel_start = pass_idx * PARALLEL_CHANNELS;
+    int num_c = (INPUT_C - channel_start < PARALLEL_CHANNELS) ? INPUT_C - channel_start : PARALLEL_CHANNELS;
+
+    for (int i = 0; i < num_c; i++) {
+
+        // Khối biến đổi input: V = B^T d B
+        int32_t d[WINO_MAX_ALPHA * WINO_MAX_ALPHA];
+        int64_t V[WINO_MAX_ALPHA * WINO_MAX_ALPHA];
+        for (int e = 0; e < aa; e++) d[e] = buffer_ifm[e * num_c + i];
+        winograd_transform_input(wino, d, V);
+
+        // Mảng PE: alpha^2 phép nhân / channel / filter
+        for (int f = f0; f < f0 + num_f; f++) {
+            const int64_t* u = buffer_u + ((size_t)(f - f0) * PARALLEL_CHANNELS + i) * aa;
+            int64_t* m_f = M + (size_t)f * aa;
+            for (int e = 0; e < aa; e++) {
+                m_f[e] += u[e] * V[e];
+            }
+        }
+        total_wino_macs += (unsigned long long)aa * num_f;
+    }
+    sram_touch(&ifm_sram, 0, (long long)num_c * aa);
+    // U của các filter trong nhóm (WINO_U_BYTES byte / phần tử) cho các channel của pass
+    for (int f = 0; f < num_f; f++) {
+        sram_touch(&weight_sram, (long long)f * num_c * aa * WINO_U_BYTES, (long long)num_c * aa * WINO_U_BYTES);
+    }
+    // Năng lượng: alpha^2 MAC / channel / filter, đọc tile IFM + U từ buffer
+    sim_pe_energy((unsigned long long)num_c * aa * num_f, (unsigned long long)num_c * aa * (1 + num_f * WINO_U_BYTES));
+    // 1 lần biến đổi input + mỗi filter 1 lượt Hadamard trên mảng PE
+    // Lượt đầu của pass mới: fill + drain pipeline cộng dồn qua các channel (SIM_PE_MODEL)
+    sim_time cycles = WINO_TRANSFORM_CYCLES + (sim_time)PE_COMPUTE_CYCLES * num_f;
+    sim_compute(&pe_array, sim_read_cycles(cycles) + pe_timing_ramp(pass_idx), &ifm_buf, &weight_buf);
+    // Utilization: mỗi lượt Hadamard trải num_c x alpha^2 phép nhân từ PE 0 (chu kỳ biến đổi không tính slot MAC)
+    pe_util_fill(pass_idx, (long long)num_c * aa, (unsigned long long)PE_COMPUTE_CYCLES * num_f);
+}
+
+// MÔ HÌNH TILE (common/tiling_planner.h)
+// Buffer IFM: tile alpha x alpha x tc; buffer Weight: U của tf filter (WINO_U_BYTES byte / phần tử).
+// Mỗi tile output, mỗi pass: load tile input 1 lần, U theo từng nhóm tf filter (mỗi nhóm biến đổi
+// input lại 1 lần). Chỉ 1 pass và 1 nhóm -> U load 1 lần cho cả layer
+void plan_model_wino(tile_plan* t) {
+    int aa = WINO_ALPHA * WINO_ALPHA;
+    unsigned long long tiles = (unsigned long long)((OUTPUT_H + WINO_M - 1) / WINO_M) * ((OUTPUT_W + WINO_M - 1) / WINO_M);
+    int stationary = (t->tc >= INPUT_C && t->tf >= OUTPUT_F);
+    t->ifm_bytes = (long long)t->tc * aa;
+    t->weight_bytes = (long long)t->tc * aa * t->tf * WINO_U_BYTES;
+    for (int c0 = 0; c0 < INPUT_C; c0 += t->tc) {
+        int nc = (INPUT_C - c0 < t->tc) ? INPUT_C - c0 : t->tc;
+        t->dma += tiles * sim_xfer_cycles((long long)nc * aa, 1);
+        for (int f0 = 0; f0 < OUTPUT_F; f0 += t->tf) {
+            int nf = (OUTPUT_F - f0 < t->tf) ? OUTPUT_F - f0 : t->tf;
+            t->dma += (stationary ? 1 : tiles) * sim_xfer_cycles((long long)nc * aa * nf * WINO_U_BYTES, 1);
+            t->compute += tiles * (WINO_TRANSFORM_CYCLES + (unsigned long long)PE_COMPUTE_CYCLES * nf);
+        }
+    }
+    t->compute += tiles * OUTPUT_F * WINO_TRANSFORM_CYCLES;
+    // Ghi kết quả cuối: mỗi hàng output của mỗi tile 1 lần
+    int tail = OUTPUT_W % WINO_M;
+    t->dma += (unsigned long long)OUTPUT_H * (OUTPUT_W / WINO_M) *
+              sim_psum_xfer_cycles((long long)WINO_M * OUTPUT_F, 1, 1, 0);
+    if (tail) t->dma += OUTPUT_H * sim_psum_xfer_cycles((long long)tail * OUTPUT_F, 1, 1, 0);
+}
+
+// CONTROLLER: WINOGRAD (Tile output m x m, accumulator giữ trên chip qua các pass)
+
+void run_accelerator_winograd() {
+    int num_passes = (INPUT_C + PARALLEL_CHANNELS - 1) / PARALLEL_CHANNELS;
+    int tiles_h = (OUTPUT_H + WINO_M - 1) / WINO_M;
+    int tiles_w = (OUTPUT_W + WINO_M - 1) / WINO_M;
+
+    int aa = WINO_ALPHA * WINO_ALPHA;
+
+    // Accumulator alpha x alpha cho mỗi filter
+    int64_t* M = (int64_t*)malloc((size_t)OUTPUT_F * aa * sizeof(int64_t));
+
+    // Chỉ 1 pass và 1 nhóm filter -> U đứng yên trong buffer cho toàn bộ layer (Weight Stationary)
+    int stationary = (num_passes == 1 && FILTER_GROUP >= OUTPUT_F);
+    if (stationary) dma_load_weights_wino(0, 0, OUTPUT_F);
+
+    for (int th = 0; th < tiles_h; th++) {
+        for (int tw = 0; tw < tiles_w; tw++) {
+
+            memset(M, 0, (size_t)OUTPUT_F * aa * sizeof(int64_t));
+
+            for (int p = 0; p < num_passes; p++) {
+                dma_load_ifm_tile(th, tw, p);
+                for (int f0 = 0; f0 < OUTPUT_F; f0 += FILTER_GROUP) {
+                    int num_f = (OUTPUT_F - f0 < FILTER_GROUP) ? OUTPUT_F - f0 : FILTER_GROUP;
+                    if (!stationary) dma_load_weights_wino(p, f0, num_f);
+                    run_pe_array_wino(p, M, f0, num_f);
+                }
+            }
+
+            for (int f = 0; f < OUTPUT_F; f++) {
+                // Khối biến đổi output: Y = A^T M A / s^2
+                int64_t Y[4 * 4];
+                winograd_transform_output(wino, M + (size_t)f * aa, Y);
+                // Chỉ đọc accumulator M trên chip, không phụ thuộc buffer
+                sim_compute(&pe_array, WINO_TRANSFORM_CYCLES, NULL, NULL);
+
+                for (int i = 0; i < WINO_M; i++) {
+                    int ho = th * WINO_M + i;
+                    if (ho >= OUTPUT_H) break;
+                    for (int j = 0; j < WINO_M; j++) {
+                        int wo = tw * WINO_M + j;
+                        if (wo >= OUTPUT_W) break;
+                        ofm_dram[(ho * OUTPUT_W + wo) * OUTPUT_F + f] = (int32_t)Y[i * WINO_M + j];
+                    }
+                }
+            }
+            // Accumulator M giữ psum qua mọi pass -> chỉ ghi kết quả cuối, mỗi hàng của tile 1 lần
+            int cols = (OUTPUT_W - tw * WINO_M < WINO_M) ? OUTPUT_W - tw * WINO_M : WINO_M;
+            for (int i = 0; i < WINO_M && th * WINO_M + i < OUTPUT_H; i++) {
+                sim_psum_update(((long long)(th * WINO_M + i) * OUTPUT_W + tw * WINO_M) * OUTPUT_F, cols * OUTPUT_F, 1, 1);
+            }
+        }
+    }
+    free(M);
+}
+
+int main(int argc, char *argv[]) {
+    // Đọc 13 tham số (common/sim_core.h), tham số sau đó (m = 2|4) là tùy chọn
+    int extra = sim_parse_args(argc, argv, " [M=2|4]");
+    if (extra < 0) return -1;
+    WINO_M = (argc > extra) ? atoi(argv[extra]) : 2;
+
+    wino = winograd_get(WINO_M);
+    if (!wino || KERNEL_H != 3 || KERNEL_W != 3 || STRIDE != 1) {
+        printf("Error: Winograd only supports 3x3 kernel, stride 1, M = 2 or 4\n");
+        return -1;
+    }
+    WINO_ALPHA = wino->alpha;
+    WINO_U_BYTES = (WINO_M == 2) ? 2 : 4;
+
+    // Tự động tính PARALLEL_CHANNELS
+    // Logic: mỗi channel cần alpha^2 phép nhân / tile
+    // Ví dụ F(2,3): (48 * 3) / (4 * 4) = 9 channels
+    int tile_size = WINO_ALPHA * WINO_ALPHA;
+    PARALLEL_CHANNELS = (NUM_PE * MACS_PER_PE) / tile_size;
+    if (PARALLEL_CHANNELS < 1) PARALLEL_CHANNELS = 1;
+
+    // Chọn số channel / pass và số filter / nhóm vừa BUFFER_SIZE_BYTES
+    if (sim_plan_tiling(1, 1, OUTPUT_F, plan_model_wino) < 0) return -1;
+    FILTER_GROUP = sim_plan.tf;
+
+    buffer_ifm = (int8_t*)malloc(PARALLEL_CHANNELS * tile_size);
+    buffer_u = (int64_t*)malloc((size_t)FILTER_GROUP * PARALLEL_CHANNELS * tile_size * sizeof(int64_t));
+
+    if (!buffer_ifm || !buffer_u) {
+        printf("Error: Malloc failed\n");
+        return -1;
+    }
+
+    sim_init();
+    // GLB (SIM_GLB=1): U được load lại ở mọi tile (khi nhiều pass / nhóm) -> ưu tiên giữ toàn bộ U, phần còn lại cho IFM
+    glb_keep(DRAM_WEIGHT, (long long)WINO_ALPHA * WINO_ALPHA * INPUT_C * OUTPUT_F * WINO_U_BYTES);
+    glb_keep(DRAM_IFM, (long long)INPUT_H * INPUT_W * INPUT_C);
+    dram_init();
+    weight_transform_offline();
+    run_accelerator_winograd();
+    write_dram_to_file();
+    sim_report();
+    // Thống kê Winograd: m, MAC thực tế, MAC của conv trực tiếp, byte IFM, byte weight
+    unsigned long long direct_macs = (unsigned long long)OUTPUT_H * OUTPUT_W * OUTPUT_F * KERNEL_H * KERNEL_W * INPUT_C;
+    printf("WINOGRAD_STATS,%d,%llu,%llu,%llu,%llu\n", WINO_M, total_wino_macs, direct_macs,
+           total_ifm_bytes, total_weight_bytes);
+
+    free(buffer_ifm);
+    free(buffer_u);
+    free(u_dram);
+    cleanup();
+
+    return 0;
+}
@@ -9,11 +9,22 @@ architectures = {
     "ISC": "config_conv2d_tiling_is.cpp",
     "WS": "config_conv2d_tiling_ws.cpp",
     "WSIS": "config_conv2d_tiling_ws_is.cpp",
-    "TL": "config_conv2d_tiling.cpp"
+    "TL": "config_conv2d_tiling.cpp",
+    "WINO": "config_conv2d_winograd.cpp",
+    "OS": "config_conv2d_tiling_os.cpp",
+    "RS": "config_conv2d_tiling_rs.cpp"
 }
 
 SHAPE_ARGS = ["112", "112", "32", "3", "3", "1", "112", "112", "1", "1"]
 target_channels = [1, 2, 4, 8, 16, 32, 48] 
+# Tham số bộ nhớ / xung nhịp đọc lúc chạy (common/sim_core.h): thêm giá trị để quét 2D / 3D, không cần biên dịch lại
+BUS_WIDTHS = [8]        # SIM_BUS_BYTES (byte / chu kỳ)
+FREQS_MHZ = [100.0]     # SIM_FREQ_MHZ
+DMA_SETUP_CYCLES = 0    # SIM_DMA_SETUP (chu kỳ / descriptor)
+DRAM_LATENCY_NS = 0.0   # SIM_DRAM_NS (ns / giao dịch)
+# File dump op TFLite (common/op_dump.h), vd ["../temp/op006_CONV_2D.txt"]: mỗi dump là 1 lớp của sweep,
+# mô phỏng lấy shape / stride / padding / IFM / Weight thẳng từ dump (không dùng SHAPE_ARGS, params/*)
+OP_DUMPS = []
 
 # --- HÀM PARSE PERF (Chuyên biệt cho format cpu_core/...) ---
 def parse_perf_text_output(stderr_text):
@@ -62,35 +73,54 @@ for name, source in architectures.items():
     subprocess.run(compile_cmd, check=True)
     print(f"Đã biên dịch {name}")
 
+# IFM / Weight dạng nhị phân (common/tensor_io.h): mô phỏng không phải parse text mỗi lần chạy,
+# thời gian perf đo được chỉ còn là phần mô phỏng dataflow. Weight ghi sẵn layout HWIO để cả 2 file
+# được mmap thẳng (các lần chạy dùng chung page cache)
+H, W, C, KH, KW, F = SHAPE_ARGS[:6]
+subprocess.run(["g++", "-O2", "tensor_convert.cpp", "-o", "tensor_convert"], check=True)
+subprocess.run(["./tensor_convert", "ifm", "../params/ifm.txt", "../params/ifm.bin", H, W, C], check=True)
+subprocess.run(["./tensor_convert", "weight_hwio", "../params/weights.txt", "../params/weights.bin", F, KH, KW, C], check=True)
+
 # --- BƯỚC 2: CHẠY KHẢO SÁT ---
 all_results = []
 print("\n--- Bắt đầu chạy Benchmark (Cần SUDO) ---")
 
-for name in architectures.keys():
-    executable = f"./{name.lower()}"
-    
-    for ch in target_channels:
+sweep = [(name, dump, ch, bus, freq) for name in architectures.keys() for dump in (OP_DUMPS or [None])
+         for ch in target_channels for bus in BUS_WIDTHS for freq in FREQS_MHZ]
+
+for name, dump, ch, bus, freq in sweep:
+        executable = f"./{name.lower()}"
         total_macs = ch * 9
         num_pe = int(total_macs / 3)
         macs_per_pe = 3
         buffer_size = total_macs
         
         # Lệnh Perf bắt sự kiện cpu_core
+        # sudo xoá biến môi trường -> truyền qua env
+        sim_env = [f"SIM_BUS_BYTES={bus}", f"SIM_FREQ_MHZ={freq}",
+                   f"SIM_DMA_SETUP={DMA_SETUP_CYCLES}", f"SIM_DRAM_NS={DRAM_LATENCY_NS}"]
         perf_cmd = [
-            "sudo", "taskset", "-c", "0-7", 
+            "sudo", "env", *sim_env, "taskset", "-c", "0-7", 
             "perf", "stat", 
             "-e", "cpu_core/cache-references/,cpu_core/cache-misses/,cpu_core/cycles/,cpu_core/instructions/,cpu_core/branches/"
         ]
         
-        app_cmd = [executable] + SHAPE_ARGS + [str(num_pe), str(macs_per_pe), str(buffer_size)]
+        layer_args = [dump] if dump else SHAPE_ARGS
+        app_cmd = [executable] + layer_args + [str(num_pe), str(macs_per_pe), str(buffer_size)]
         full_cmd = perf_cmd + app_cmd
         
         try:
             result = subprocess.run(full_cmd, capture_output=True, text=True)
             
             # 1. Lấy kết quả từ code C++ (NHƯ CODE CŨ CỦA BẠN)
-            match_cpp = re.search(r"SURVEY_RESULT,(\d+),(\d+),(\d+)", result.stdout)
+            # SURVEY_RESULT,DMA,COMPUTE,TOTAL,ENERGY,E_DRAM,E_SRAM,E_REG,E_MAC (năng lượng: pJ)
+            match_cpp = re.search(r"SURVEY_RESULT,(\d+),(\d+),(\d+)(?:,([\d.]+),([\d.]+),([\d.]+),([\d.]+),([\d.]+))?", result.stdout)
             
+            # UTIL_STATS,MAC thật,MAC-slot,utilization tổng,utilization không gian,pass thấp nhất,PE không dùng
+            # TIME_STATS,MHz,bus,chu kỳ PE,overhead DMA,tổng (us),DMA (us),compute (us),số descriptor DMA
+            match_time = re.search(r"TIME_STATS,([\d.]+),(\d+),(\d+),(\d+),([\d.]+),[\d.]+,[\d.]+,(\d+)", result.stdout)
+            match_util = re.search(r"UTIL_STATS,(\d+),(\d+),([\d.]+),([\d.]+),([\d.]+),(\d+)", result.stdout)
+
             # 2. Lấy kết quả từ Perf
             perf_data = parse_perf_text_output(result.stderr)
             
@@ -98,6 +128,9 @@ for name in architectures.keys():
                 dma = int(match_cpp.group(1))
                 comp = int(match_cpp.group(2))
                 total_hw = int(match_cpp.group(3))
+                energy = [float(match_cpp.group(i)) if match_cpp.group(i) else 0.0 for i in range(4, 9)]
+                active_macs = int(match_util.group(1)) if match_util else 0
+                mac_slots = int(match_util.group(2)) if match_util else 0
                 
                 # Tính toán số liệu Perf
                 cache_refs = perf_data["cache-references"]
@@ -107,15 +140,33 @@ for name in architectures.keys():
                 # --- ĐÂY LÀ PHẦN QUAN TRỌNG: GỘP CẢ 2 ---
                 record = {
                     "Architecture": name,
+                    "Layer": os.path.basename(dump) if dump else "params",
                     "Parallel_Channels": ch,
                     "Total_MACs": total_macs,
                     "NUM_PE": num_pe,                 # <--- THÊM DÒNG NÀY
                     "MACS_PER_PE": macs_per_pe,       # <--- THÊM DÒNG NÀY
                     "BUFFER_SIZE_BYTES": buffer_size, # <--- THÊM DÒNG NÀY
+                    "Bus_Bytes": bus,
+                    "Freq_MHz": freq,
                     # === NHÓM 1: DỮ LIỆU TỪ CODE CŨ (Simulation) ===
                     "DMA_Cycles": dma,        # <--- Đã thêm lại
                     "Compute_Cycles": comp,   # <--- Đã thêm lại
                     "Total_Cycles": total_hw, # <--- Đã thêm lại (Simulated)
+                    "Energy_pJ": energy[0],
+                    "DRAM_pJ": energy[1],
+                    "SRAM_pJ": energy[2],
+                    "REG_pJ": energy[3],
+                    "MAC_pJ": energy[4],
+                    "EDP": energy[0] * total_hw,  # Energy-Delay Product (pJ x cycle)
+                    "Time_us": float(match_time.group(5)) if match_time else total_hw / freq,
+                    "DMA_Descriptors": int(match_time.group(6)) if match_time else 0,
+                    # Utilization thật của mảng PE (MAC thật / MAC-slot của các chu kỳ compute)
+                    "Active_MACs": active_macs,
+                    "MAC_Slots": mac_slots,
+                    "Utilization": float(match_util.group(3)) if match_util else 0.0,
+                    "Spatial_Utilization": float(match_util.group(4)) if match_util else 0.0,
+                    "Idle_PEs": int(match_util.group(6)) if match_util else 0,
+                    "MAC_per_cycle": active_macs / total_hw if total_hw > 0 else 0.0,
                     
                     # === NHÓM 2: DỮ LIỆU TỪ PERF (Real Hardware) ===
                     "cpu_core_cache": cache_refs,
@@ -129,9 +180,9 @@ for name in architectures.keys():
                 }
                 
                 all_results.append(record)
-                print(f"[{name}] Ch={ch:2d} | Sim_Cycles={total_hw} | Perf_Sec={perf_data['seconds']:.5f}")
+                print(f"[{name}] Ch={ch:2d} Bus={bus} F={freq:.0f}MHz | Sim_Cycles={total_hw} | Energy={energy[0] / 1e6:.2f} uJ | Util={mac_slots and active_macs / mac_slots:.2f} | Perf_Sec={perf_data['seconds']:.5f}")
             else:
-                print(f"Lỗi: Không tìm thấy SURVEY_RESULT cho {name} (ch={ch})")
+                print(f"Lỗi: Không tìm thấy SURVEY_RESULT cho {name} (ch={ch}, bus={bus}, freq={freq})")
                 
         except Exception as e:
             print(f"Exception tại {name} ch={ch}: {e}")
@@ -176,6 +227,25 @@ if all_results:
     plt.legend()
     plt.savefig("comparison_report_real.png")
     
-    print("--- Đã vẽ xong 2 biểu đồ (Sim và Real) ---")
+    # --- VẼ BIỂU ĐỒ 3: NĂNG LƯỢNG VÀ EDP (Simulation) ---
+    fig, (ax_e, ax_edp) = plt.subplots(1, 2, figsize=(16, 7))
+    for name in architectures.keys():
+        data = df[df["Architecture"] == name]
+        ax_e.plot(data["Total_MACs"], data["Energy_pJ"] / 1e6, marker='o', label=name, linewidth=2)
+        ax_edp.plot(data["Total_MACs"], data["EDP"], marker='o', label=name, linewidth=2)
+
+    ax_e.set_title("Năng lượng (Simulation)")
+    ax_e.set_ylabel("Energy (uJ)")
+    ax_edp.set_title("Energy-Delay Product (Simulation)")
+    ax_edp.set_ylabel("EDP (pJ x cycle)")
+    for ax in (ax_e, ax_edp):
+        ax.set_xlabel("Tài nguyên phần cứng (Tổng số MACs)")
+        ax.set_xscale('log')
+        ax.set_yscale('log')
+        ax.grid(True, which="both", ls="-", alpha=0.5)
+        ax.legend()
+    plt.savefig("comparison_report_energy.png")
+
+    print("--- Đã vẽ xong 3 biểu đồ (Sim, Real và Energy) ---")
 else:
     print("Không có dữ liệu.")
\ No newline at end of file
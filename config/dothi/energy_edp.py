@@ -0,0 +1,96 @@
+import pandas as pd
+import matplotlib.pyplot as plt
+import os
+
+# ====== Paths ======
+CSV_PATH = "master_survey_results_FULL.csv"  # CSV cùng folder với script (do dodac.py tạo)
+OUT_DIR = "plots"                            # lưu hình vào ./plots
+
+# ====== Config ======
+AGG = "min"  # "min" / "mean" / "median" nếu trùng (Architecture, NUM_PE)
+TITLE_ENERGY = "Energy_vs_NUM_PE"
+TITLE_EDP = "EDP_vs_NUM_PE"
+TITLE_BREAKDOWN = "Energy_breakdown_vs_NUM_PE"
+PARTS = ["DRAM_pJ", "SRAM_pJ", "REG_pJ", "MAC_pJ"]
+
+# ====== Ensure output folder exists ======
+os.makedirs(OUT_DIR, exist_ok=True)
+
+# ====== Load & clean ======
+df = pd.read_csv(CSV_PATH)
+
+required = {"NUM_PE", "Architecture", "Total_Cycles", "Energy_pJ"} | set(PARTS)
+missing = required - set(df.columns)
+if missing:
+    raise ValueError(f"Missing columns: {missing}. Available: {list(df.columns)}")
+
+for col in ["NUM_PE", "Total_Cycles", "Energy_pJ"] + PARTS:
+    df[col] = pd.to_numeric(df[col], errors="coerce")
+df["Architecture"] = df["Architecture"].astype(str)
+
+df = df.dropna(subset=["NUM_PE", "Total_Cycles", "Energy_pJ", "Architecture"])
+df = df[(df["NUM_PE"] > 0) & (df["Total_Cycles"] > 0) & (df["Energy_pJ"] > 0)]
+
+# ====== Create metric ======
+# EDP = Energy x Delay (pJ x cycle); tính lại từ CSV để không phụ thuộc cột EDP
+df["EDP"] = df["Energy_pJ"] * df["Total_Cycles"]
+df["Energy_uJ"] = df["Energy_pJ"] / 1e6
+
+# ====== Aggregate duplicates ======
+cols = ["Energy_uJ", "EDP"] + PARTS
+if AGG == "min":
+    plot_df = df.groupby(["Architecture", "NUM_PE"], as_index=False)[cols].min()
+elif AGG == "mean":
+    plot_df = df.groupby(["Architecture", "NUM_PE"], as_index=False)[cols].mean()
+elif AGG == "median":
+    plot_df = df.groupby(["Architecture", "NUM_PE"], as_index=False)[cols].median()
+else:
+    raise ValueError("AGG must be one of: 'min', 'mean', 'median'")
+
+plot_df = plot_df.sort_values(["Architecture", "NUM_PE"])
+
+# ====== Plot 1 + 2: Energy, EDP ======
+for title, col, ylabel in [(TITLE_ENERGY, "Energy_uJ", "Energy (uJ, log scale)"),
+                           (TITLE_EDP, "EDP", "EDP = Energy_pJ x Total_Cycles (log scale)")]:
+    fig, ax = plt.subplots(figsize=(9, 5))
+    for arch, sub in plot_df.groupby("Architecture", sort=False):
+        ax.plot(sub["NUM_PE"], sub[col], marker="o", linewidth=2, label=arch)
+
+    ax.set_title(title)
+    ax.set_xlabel("NUM_PE")
+    ax.set_ylabel(ylabel)
+    ax.set_yscale("log")
+    ax.grid(True, which="both", linestyle="--", linewidth=0.6, alpha=0.6)
+    ax.legend(title="Architecture", bbox_to_anchor=(1.02, 1), loc="upper left")
+    plt.tight_layout()
+
+    out_path = os.path.join(OUT_DIR, f"{title}.png")
+    fig.savefig(out_path, dpi=200, bbox_inches="tight")
+    print("Saved:", out_path)
+
+# ====== Plot 3: Breakdown (stacked bar, 1 subplot / Architecture) ======
+architectures = list(plot_df["Architecture"].unique())
+fig, axes = plt.subplots(1, len(architectures), figsize=(4 * len(architectures), 5), sharey=True, squeeze=False)
+
+for ax, arch in zip(axes[0], architectures):
+    sub = plot_df[plot_df["Architecture"] == arch]
+    x = [str(int(v)) for v in sub["NUM_PE"]]
+    bottom = [0.0] * len(sub)
+    for part in PARTS:
+        vals = list(sub[part] / 1e6)
+        ax.bar(x, vals, bottom=bottom, label=part.replace("_pJ", ""))
+        bottom = [b + v for b, v in zip(bottom, vals)]
+    ax.set_title(arch)
+    ax.set_xlabel("NUM_PE")
+    ax.grid(True, axis="y", linestyle="--", linewidth=0.6, alpha=0.6)
+
+axes[0][0].set_ylabel("Energy (uJ)")
+axes[0][-1].legend(title="Thành phần", bbox_to_anchor=(1.02, 1), loc="upper left")
+fig.suptitle(TITLE_BREAKDOWN)
+plt.tight_layout()
+
+out_path = os.path.join(OUT_DIR, f"{TITLE_BREAKDOWN}.png")
+fig.savefig(out_path, dpi=200, bbox_inches="tight")
+print("Saved:", out_path)
+
+plt.show()
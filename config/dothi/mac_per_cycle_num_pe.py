@@ -16,21 +16,22 @@ os.makedirs(OUT_DIR, exist_ok=True)
 # ====== Load & clean ======
 df = pd.read_csv(CSV_PATH)
 
-required = {"NUM_PE", "Architecture", "Total_MACs", "Total_Cycles"}
+# Total_MACs là số MAC cấu hình; Active_MACs là số MAC mảng PE thật sự làm (UTIL_STATS, do dodac.py ghi)
+required = {"NUM_PE", "Architecture", "Active_MACs", "Total_Cycles"}
 missing = required - set(df.columns)
 if missing:
     raise ValueError(f"Missing columns: {missing}. Available: {list(df.columns)}")
 
 df["NUM_PE"] = pd.to_numeric(df["NUM_PE"], errors="coerce")
-df["Total_MACs"] = pd.to_numeric(df["Total_MACs"], errors="coerce")
+df["Active_MACs"] = pd.to_numeric(df["Active_MACs"], errors="coerce")
 df["Total_Cycles"] = pd.to_numeric(df["Total_Cycles"], errors="coerce")
 df["Architecture"] = df["Architecture"].astype(str)
 
-df = df.dropna(subset=["NUM_PE", "Total_MACs", "Total_Cycles", "Architecture"])
-df = df[(df["NUM_PE"] > 0) & (df["Total_MACs"] >= 0) & (df["Total_Cycles"] > 0)]
+df = df.dropna(subset=["NUM_PE", "Active_MACs", "Total_Cycles", "Architecture"])
+df = df[(df["NUM_PE"] > 0) & (df["Active_MACs"] >= 0) & (df["Total_Cycles"] > 0)]
 
 # ====== Create metric ======
-df["Throughput_MAC_per_cycle"] = df["Total_MACs"] / df["Total_Cycles"]
+df["Throughput_MAC_per_cycle"] = df["Active_MACs"] / df["Total_Cycles"]
 
 # ====== Aggregate duplicates ======
 if AGG == "min":
@@ -52,7 +53,7 @@ for arch, sub in plot_df.groupby("Architecture", sort=False):
 
 ax.set_title(TITLE)
 ax.set_xlabel("NUM_PE")
-ax.set_ylabel("Throughput_MAC_per_cycle = Total_MACs / Total_Cycles")
+ax.set_ylabel("Throughput_MAC_per_cycle = Active_MACs / Total_Cycles")
 ax.grid(True, linestyle="--", linewidth=0.6, alpha=0.6)
 ax.legend(title="Architecture", bbox_to_anchor=(1.02, 1), loc="upper left")
 plt.tight_layout()
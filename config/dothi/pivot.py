@@ -16,7 +16,7 @@ NUM_PE_LIST = [3, 6, 12, 24, 48]
 METRICS = [
     ("Total_Cycles", "Total_Cycles", "Total_Cycles"),
     ("DMA_ratio", "DMA_ratio", "DMA_ratio = DMA_Cycles / Total_Cycles"),
-    ("Throughput_MAC_per_cycle", "Throughput_MAC_per_cycle", "MAC / cycle = Total_MACs / Total_Cycles"),
+    ("Throughput_MAC_per_cycle", "Throughput_MAC_per_cycle", "MAC / cycle = Active_MACs / Total_Cycles"),
 ]
 
 def agg_func_name(agg: str) -> str:
@@ -56,14 +56,15 @@ def make_metric_value(df: pd.DataFrame, metric_key: str) -> pd.DataFrame:
         df = df[(df["metric_value"] >= 0) & (df["metric_value"] <= 1)]
 
     elif metric_key == "Throughput_MAC_per_cycle":
-        for c in ["Total_MACs", "Total_Cycles"]:
+        # MAC thật của mảng PE (UTIL_STATS), không phải số MAC cấu hình Total_MACs
+        for c in ["Active_MACs", "Total_Cycles"]:
             if c not in df.columns:
                 raise ValueError(f"Missing column '{c}' for Throughput_MAC_per_cycle")
-        df["Total_MACs"] = pd.to_numeric(df["Total_MACs"], errors="coerce")
+        df["Active_MACs"] = pd.to_numeric(df["Active_MACs"], errors="coerce")
         df["Total_Cycles"] = pd.to_numeric(df["Total_Cycles"], errors="coerce")
-        df = df.dropna(subset=["Total_MACs", "Total_Cycles"])
-        df = df[(df["Total_MACs"] >= 0) & (df["Total_Cycles"] > 0)]
-        df["metric_value"] = df["Total_MACs"] / df["Total_Cycles"]
+        df = df.dropna(subset=["Active_MACs", "Total_Cycles"])
+        df = df[(df["Active_MACs"] >= 0) & (df["Total_Cycles"] > 0)]
+        df["metric_value"] = df["Active_MACs"] / df["Total_Cycles"]
 
     else:
         raise ValueError("Unknown metric_key")
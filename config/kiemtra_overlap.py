@@ -0,0 +1,42 @@
+import subprocess
+import os
+import sys
+
+# KIỂM TRA CHỒNG LẤP DMA / COMPUTE (SIM_OVERLAP=1, psum bật như mặc định)
+# Mỗi dataflow phải cho total chồng lấp < total tuần tự (OVERLAP_STATS cột 1, 2).
+# Lệnh ghi psum / OFM xếp chung hàng đợi với prefetch từng làm 2 số này bằng nhau (mất hẳn chồng lấp).
+# Chạy trong thư mục config (cần ../params): python3 kiemtra_overlap.py, trả về 1 nếu có dataflow lỗi.
+
+architectures = {
+    "ISC": "config_conv2d_tiling_is.cpp",
+    "WS": "config_conv2d_tiling_ws.cpp",
+    "WSIS": "config_conv2d_tiling_ws_is.cpp",
+    "TL": "config_conv2d_tiling.cpp",
+    "WINO": "config_conv2d_winograd.cpp",
+    "OS": "config_conv2d_tiling_os.cpp",
+    "RS": "config_conv2d_tiling_rs.cpp"
+}
+
+SHAPE_ARGS = ["112", "112", "32", "3", "3", "1", "112", "112", "1", "1"]
+HW_ARGS = ["48", "3", "144"]
+
+failed = 0
+env = dict(os.environ, SIM_OVERLAP="1")
+env.pop("SIM_PSUM", None)
+for name, source in architectures.items():
+    exe = "./kiemtra_" + name.lower()
+    subprocess.run(["g++", "-O2", source, "-o", exe], check=True)
+    out = subprocess.run([exe] + SHAPE_ARGS + HW_ARGS, env=env, capture_output=True, text=True).stdout
+    os.remove(exe)
+    stats = [line for line in out.splitlines() if line.startswith("OVERLAP_STATS")]
+    if not stats:
+        print(f"{name}: LỖI, không có OVERLAP_STATS")
+        failed += 1
+        continue
+    seq, total = [int(x) for x in stats[0].split(",")[1:3]]
+    ok = total < seq
+    print(f"{name}: tuần tự {seq}, chồng lấp {total} -> {'OK' if ok else 'LỖI'}")
+    if not ok:
+        failed += 1
+
+sys.exit(1 if failed else 0)
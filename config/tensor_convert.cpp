@@ -0,0 +1,169 @@
+// CHUYỂN FILE TENSOR TEXT <-> NHỊ PHÂN (common/tensor_io.h)
+//
+// g++ -O2 tensor_convert.cpp -o tensor_convert
+//   ./tensor_convert ifm    ../params/ifm.txt     ../params/ifm.bin     112 112 32 [scale zero_point]
+//   ./tensor_convert weight ../params/weights.txt ../params/weights.bin 1 3 3 32 [scale zero_point]
+//   ./tensor_convert weight_hwio ../params/weights.txt ../params/weights.bin 1 3 3 32   (mmap thẳng được)
+//   ./tensor_convert ofm    ../golden_output/ofm_golden.txt ../golden_output/ofm_golden.bin 112 112 1
+//   ./tensor_convert txt    ../ofm/ofm.bin ../ofm/ofm.txt        (ngược lại: 1 số / dòng như file cũ)
+//   ./tensor_convert ifm    ../params/ifm.txt ../params/ifm.npy 112 112 32   (đuôi .npy: ghi NumPy .npy)
+//   ./tensor_convert txt    ../ofm/ofm.npy ../ofm/ofm.txt        (đọc được cả .npy số nguyên)
+//   ./tensor_convert opdump ../temp/op006_CONV_2D.txt ../params     (file dump op TFLite, common/op_dump.h)
+// ifm: int8 NHWC [H][W][C]; weight: int8 OHWI [F][KH][KW][C] (thứ tự của weights.txt);
+// weight_hwio: int8 HWIO [KH][KW][C][F] (layout weight_dram, mô phỏng mmap thẳng không cần sắp lại);
+// ofm: int32 NHWC [H][W][F]. Text thiếu dòng -> phần còn lại là 0 (giống dram_init).
+// .npy giữ shape theo layout (weight: (F, KH, KW, C), weight_hwio: (KH, KW, C, F) = HWCF), không có scale.
+// opdump: ghi ifm.bin, weights.bin (OHWI), bias.bin (int32), ofm_ref.bin (int8 đã requant của TFLite) vào
+// thư mục đích, kèm scale / zero_point (scale theo từng channel: chỉ in ra), in 10 tham số lớp cho mô phỏng.
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "../common/tensor_io.h"
+#include "../common/op_dump.h"
+
+void usage(const char* prog) {
+    printf("Usage: %s ifm <in.txt> <out.bin> H W C [scale zero_point]\n", prog);
+    printf("       %s weight <in.txt> <out.bin> F KH KW C [scale zero_point]\n", prog);
+    printf("       %s weight_hwio <in.txt> <out.bin> F KH KW C [scale zero_point]\n", prog);
+    printf("       %s ofm <in.txt> <out.bin> H W F [scale zero_point]\n", prog);
+    printf("       %s txt <in.bin|in.npy> <out.txt>\n", prog);
+    printf("       %s opdump <op_dump.txt> <out_dir>\n", prog);
+    printf("Output ending in .npy is written as a NumPy .npy file\n");
+}
+
+int to_text(const char* in, const char* out) {
+    tensor_header h;
+    void* data = tensor_is_npy(in) ? tensor_load_npy(in, &h, 0) : tensor_load(in, &h);
+    if (!data) return -1;
+    FILE* f = fopen(out, "w");
+    if (!f) {
+        printf("Error: Could not open %s\n", out);
+        free(data);
+        return -1;
+    }
+    long long n = tensor_elems(&h);
+    for (long long i = 0; i < n; i++) {
+        fprintf(f, "%d\n", (h.dtype == TENSOR_I8) ? ((int8_t*)data)[i] : ((int32_t*)data)[i]);
+    }
+    fclose(f);
+    free(data);
+    printf("%s: %lld elements, layout %d, shape [%u, %u, %u, %u]\n", out, n, h.layout,
+           h.dims[0], h.dims[1], h.dims[2], h.dims[3]);
+    return 0;
+}
+
+// 1 tensor của dump -> <dir>/<name>.bin (bỏ batch của IFM / OFM)
+int save_dump_tensor(const op_dump_tensor* t, int layout, const char* dir, const char* name) {
+    if (!t->data) {
+        printf("Warning: op dump has no %s values\n", name);
+        return 0;
+    }
+    int skip = (layout == TENSOR_NHWC && t->ndim == 4 && t->dims[0] == 1) ? 1 : 0;
+    tensor_header h = tensor_header_make(t->dtype, layout, t->ndim - skip, t->dims + skip);
+    if (t->nq == 1) {
+        h.scale = t->scales[0];
+        h.zero_point = t->zero_points[0];
+    }
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%s.bin", dir, name);
+    if (tensor_save(path, &h, t->data) < 0) {
+        printf("Error: Could not write %s\n", path);
+        return -1;
+    }
+    printf("%s: %lld elements, shape [%u, %u, %u, %u], %d scale(s)\n", path, tensor_elems(&h), h.dims[0], h.dims[1],
+           h.dims[2], h.dims[3], t->nq);
+    return 0;
+}
+
+int from_op_dump(const char* in, const char* dir) {
+    op_dump d;
+    if (op_dump_load(in, &d) < 0) {
+        printf("Error: Could not open %s\n", in);
+        return -1;
+    }
+    int ret = op_dump_layer(&d, in);
+    if (ret == 0) {
+        ret = save_dump_tensor(&d.t[OP_DUMP_IFM], TENSOR_NHWC, dir, "ifm") |
+              save_dump_tensor(&d.t[OP_DUMP_WEIGHTS], TENSOR_OHWI, dir, "weights") |
+              save_dump_tensor(&d.t[OP_DUMP_BIAS], TENSOR_NHWC, dir, "bias") |
+              save_dump_tensor(&d.t[OP_DUMP_OFM], TENSOR_NHWC, dir, "ofm_ref");
+        printf("%s %s #%d: IH IW IC KH KW OF OH OW S P = %d %d %d %d %d %d %d %d %d %d\n", d.model, d.op, d.op_index,
+               d.in_h, d.in_w, d.in_c, d.k_h, d.k_w, d.out_f, d.out_h, d.out_w, d.stride_h, d.pad_top);
+    }
+    op_dump_free(&d);
+    return ret;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 4) {
+        usage(argv[0]);
+        return -1;
+    }
+    const char* kind = argv[1];
+    if (strcmp(kind, "txt") == 0) return to_text(argv[2], argv[3]) < 0 ? -1 : 0;
+    if (strcmp(kind, "opdump") == 0) return from_op_dump(argv[2], argv[3]) < 0 ? -1 : 0;
+
+    int dtype, layout, ndim;
+    if (strcmp(kind, "ifm") == 0) {
+        dtype = TENSOR_I8, layout = TENSOR_NHWC, ndim = 3;
+    } else if (strcmp(kind, "weight") == 0) {
+        dtype = TENSOR_I8, layout = TENSOR_OHWI, ndim = 4;
+    } else if (strcmp(kind, "weight_hwio") == 0) {
+        dtype = TENSOR_I8, layout = TENSOR_HWIO, ndim = 4;
+    } else if (strcmp(kind, "ofm") == 0) {
+        dtype = TENSOR_I32, layout = TENSOR_NHWC, ndim = 3;
+    } else {
+        usage(argv[0]);
+        return -1;
+    }
+    if (argc < 4 + ndim) {
+        usage(argv[0]);
+        return -1;
+    }
+    int dims[4];
+    for (int i = 0; i < ndim; i++) {
+        dims[i] = atoi(argv[4 + i]);
+        if (dims[i] <= 0) {
+            printf("Error: dimension %d must be positive\n", i);
+            return -1;
+        }
+    }
+    // Text luôn theo thứ tự dims dòng lệnh; weight_hwio sắp lại thành [KH][KW][C][F]
+    int file_dims[4] = { dims[0], dims[1], dims[2], dims[3] };
+    if (layout == TENSOR_HWIO) {
+        file_dims[0] = dims[1], file_dims[1] = dims[2], file_dims[2] = dims[3], file_dims[3] = dims[0];
+    }
+    tensor_header h = tensor_header_make(dtype, layout, ndim, file_dims);
+    if (argc > 4 + ndim) h.scale = (float)atof(argv[4 + ndim]);
+    if (argc > 5 + ndim) h.zero_point = atoi(argv[5 + ndim]);
+
+    long long n = tensor_elems(&h);
+    void* data = calloc(n, dtype);
+    if (!data) {
+        printf("Error: Malloc failed\n");
+        return -1;
+    }
+    long long got = tensor_read_text(argv[2], dtype, n, data);
+    if (got < 0) {
+        printf("Error: Could not open %s\n", argv[2]);
+        free(data);
+        return -1;
+    }
+    if (got < n) printf("Warning: %s has %lld of %lld values, the rest are 0\n", argv[2], got, n);
+    if (layout == TENSOR_HWIO) {
+        // F->KH->KW->C (text) -> [KH][KW][C][F]
+        long long f_num = dims[0], k_size = (long long)dims[1] * dims[2] * dims[3];
+        int8_t* hwio = (int8_t*)malloc(n);
+        for (long long f = 0; f < f_num; f++)
+            for (long long k = 0; k < k_size; k++) hwio[k * f_num + f] = ((int8_t*)data)[f * k_size + k];
+        free(data);
+        data = hwio;
+    }
+    int ret = tensor_is_npy(argv[3]) ? tensor_save_npy(argv[3], dtype, ndim, file_dims, data)
+                                     : tensor_save(argv[3], &h, data);
+    if (ret < 0) printf("Error: Could not write %s\n", argv[3]);
+    else printf("%s: %lld elements\n", argv[3], n);
+    free(data);
+    return ret;
+}
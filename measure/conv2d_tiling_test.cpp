@@ -4,6 +4,7 @@
 #include <inttypes.h>
 #include <string.h>
 #include <math.h>
+#include "../common/pe_simd.h"
 
 // --- CẤU HÌNH BÀI TOÁN ---
 #define INPUT_H 112
@@ -137,19 +138,8 @@ void dma_load_buffers(int ho, int wo, int pass_idx) {
 
 // MÔ PHỎNG COMPUTE ENGINE
 int32_t run_pe_array() {
-    int32_t partial_sum = 0;
-
-    // Logic tính toán chức năng (Functional)
-    for (int pe_id = 0; pe_id < NUM_PE; pe_id++) {
-        int base_idx = pe_id * MACS_PER_PE; 
-        int32_t pe_acc = 0; 
-        for (int k = 0; k < MACS_PER_PE; k++) {//tinh het so MAC cua 1 con PE
-            int8_t a = buffer_ifm[base_idx + k];
-            int8_t b = buffer_weight[base_idx + k];
-            pe_acc += (int32_t)a * (int32_t)b;
-        }
-        partial_sum += pe_acc; // tong cua 48 con PE
-    }
+    // NUM_PE x MACS_PER_PE phép MAC được gom thành 1 tích vô hướng int8 (kernel SIMD)
+    int32_t partial_sum = pe_dot_i8(buffer_ifm, buffer_weight, NUM_PE * MACS_PER_PE);
 
     return partial_sum;
 }
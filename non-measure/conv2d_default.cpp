@@ -3,6 +3,9 @@
 #include <stdint.h>
 #include <string.h>
 #include <math.h>
+#include "../common/gemm_i8.h"
+#include "../common/winograd.h"
+#include "../common/tensor_io.h"
 
 // --- CẤU HÌNH KÍCH THƯỚC (Theo shape [1, 3, 3, 32]) ---
 #define INPUT_H 112
@@ -23,68 +26,121 @@
 
 // --------------------------------------------------------
 
-// Hàm đọc file IFM
-int8_t* read_ifm_file(const char* filename) {
-    FILE* file = fopen(filename, "r");
-    if (!file) {
-        printf("Error: Cannot open file %s\n", filename);
-        exit(1);
+// Đọc IFM / Weight từ .npy (np.save của script Python, int8 / int16 / int32).
+// IFM shape (H, W, C) hoặc (1, H, W, C); Weight (KH, KW, C, F) = HWCF hoặc (F, KH, KW, C).
+// Trả về NULL nếu không có file hoặc shape không khớp
+int8_t* read_ifm_npy(const char* filename) {
+    tensor_header h;
+    int8_t* data = (int8_t*)tensor_load_npy(filename, &h, TENSOR_I8);
+    if (!data) return NULL;
+    int dims[4] = { INPUT_H, INPUT_W, INPUT_C, 1 };
+    int dims4[4] = { 1, INPUT_H, INPUT_W, INPUT_C };
+    if (!tensor_match(&h, TENSOR_I8, TENSOR_NHWC, 3, dims) && !tensor_match(&h, TENSOR_I8, TENSOR_NHWC, 4, dims4)) {
+        printf("Error: %s has shape [%u, %u, %u, %u]\n", filename, h.dims[0], h.dims[1], h.dims[2], h.dims[3]);
+        free(data);
+        return NULL;
+    }
+    return data;
+}
+
+int16_t* read_weight_npy(const char* filename) {
+    tensor_header h;
+    int8_t* data = (int8_t*)tensor_load_npy(filename, &h, TENSOR_I8);
+    if (!data) return NULL;
+    int hwcf[4] = { KERNEL_H, KERNEL_W, INPUT_C, -1 };
+    int ohwi[4] = { -1, KERNEL_H, KERNEL_W, INPUT_C };
+    int k_size = KERNEL_H * KERNEL_W * INPUT_C;
+    int16_t* weights = (int16_t*)malloc(k_size * OUTPUT_F * sizeof(int16_t));
+    if (tensor_match(&h, TENSOR_I8, TENSOR_NHWC, 4, hwcf) && (int)h.dims[3] >= OUTPUT_F) {
+        int f_num = h.dims[3];
+        for (int k = 0; k < k_size; k++)
+            for (int f = 0; f < OUTPUT_F; f++) weights[k * OUTPUT_F + f] = data[k * f_num + f];
+    } else if (tensor_match(&h, TENSOR_I8, TENSOR_NHWC, 4, ohwi) && (int)h.dims[0] >= OUTPUT_F) {
+        for (int f = 0; f < OUTPUT_F; f++)
+            for (int k = 0; k < k_size; k++) weights[k * OUTPUT_F + f] = data[f * k_size + k];
+    } else {
+        printf("Error: %s has shape [%u, %u, %u, %u]\n", filename, h.dims[0], h.dims[1], h.dims[2], h.dims[3]);
+        free(weights);
+        weights = NULL;
     }
+    free(data);
+    return weights;
+}
 
+// Hàm đọc file IFM (text, 1 số / dòng: đọc cả file 1 lần rồi quét, common/tensor_io.h; .npy: read_ifm_npy)
+int8_t* read_ifm_file(const char* filename) {
+    if (tensor_is_npy(filename)) {
+        int8_t* data = read_ifm_npy(filename);
+        if (!data) {
+            printf("Error: Cannot open file %s\n", filename);
+            exit(1);
+        }
+        return data;
+    }
     int total_elements = INPUT_H * INPUT_W * INPUT_C;
-    int8_t* data = (int8_t*)malloc(total_elements * sizeof(int8_t));
-    
-    char line[64];
-    int index = 0;
-    while (fgets(line, sizeof(line), file)) {
-        if (index >= total_elements) break;
-        int val = atoi(line);
-        data[index] = (int8_t)val;
-        index++;
+    int8_t* data = (int8_t*)calloc(total_elements, sizeof(int8_t));
+    if (tensor_read_text(filename, TENSOR_I8, total_elements, data) < 0) {
+        printf("Error: Cannot open file %s\n", filename);
+        exit(1);
     }
-    fclose(file);
     return data;
 }
 
 // Hàm đọc file Weight
 // Cấu trúc file tuân theo shape [Filter, H, W, Channel]
-// Nhưng lưu vào bộ nhớ theo layout [H, W, C, F] để tiện tính toán
+// Nhưng lưu vào bộ nhớ theo layout [H, W, C, F] để tiện tính toán (.npy: read_weight_npy)
 int16_t* read_file_weight(const char* filename) {
-    FILE* file = fopen(filename, "r");
-    if (!file) {
+    if (tensor_is_npy(filename)) {
+        int16_t* weights = read_weight_npy(filename);
+        if (!weights) {
+            printf("Error: Cannot open file %s\n", filename);
+            exit(1);
+        }
+        return weights;
+    }
+    int k_size = KERNEL_H * KERNEL_W * INPUT_C;
+    int total_elements = k_size * OUTPUT_F;
+    int8_t* data = (int8_t*)calloc(total_elements, sizeof(int8_t));
+    if (tensor_read_text(filename, TENSOR_I8, total_elements, data) < 0) {
         printf("Error: Cannot open file %s\n", filename);
         exit(1);
     }
+    int16_t* weights = (int16_t*)malloc(total_elements * sizeof(int16_t));
+    // File: Filter -> H -> W -> Channel; bộ nhớ: index = (h*(W*C) + w*C + c)*F + f
+    for (int f = 0; f < OUTPUT_F; f++)
+        for (int k = 0; k < k_size; k++) weights[k * OUTPUT_F + f] = data[f * k_size + k];
+    free(data);
+    return weights;
+}
 
-    int total_elements = KERNEL_H * KERNEL_W * INPUT_C * OUTPUT_F;
-    int16_t* weights = (int16_t*)calloc(total_elements, sizeof(int16_t));
-    
-    char line[64];
-    
-    // Thứ tự Loop đọc file: Filter -> H -> W -> Channel
-    for (int f = 0; f < OUTPUT_F; f++) {        // Dim 0: Filter (1)
-        for (int h = 0; h < KERNEL_H; h++) {    // Dim 1: Height (3)
-            for (int w = 0; w < KERNEL_W; w++) {// Dim 2: Width  (3)
-                for (int c = 0; c < INPUT_C; c++) { // Dim 3: Channel (32)
-                    
-                    if (fgets(line, sizeof(line), file)) {
-                        int val = atoi(line);
-                        if (val > 0x7F) val -= 0x100;
-                        
-                        // Mapping vào bộ nhớ theo layout [H][W][C][F]
-                        // Index = h*(W*C*F) + w*(C*F) + c*F + f
-                        int dest_index = h * (KERNEL_W * INPUT_C * OUTPUT_F) + 
-                                         w * (INPUT_C * OUTPUT_F) + 
-                                         c * OUTPUT_F + 
-                                         f;
-                        
-                        weights[dest_index] = (int16_t)val;
-                    }
-                }
-            }
-        }
+// Đọc IFM / Weight từ file tensor nhị phân (tạo bằng config/tensor_convert.cpp), không phải parse text.
+// Trả về NULL nếu không có file hoặc shape không khớp -> dùng file .txt
+int8_t* read_ifm_bin(const char* filename) {
+    tensor_header h;
+    int8_t* data = (int8_t*)tensor_load(filename, &h);
+    int dims[3] = { INPUT_H, INPUT_W, INPUT_C };
+    if (data && !tensor_check(filename, &h, TENSOR_I8, TENSOR_NHWC, 3, dims)) {
+        free(data);
+        data = NULL;
     }
-    fclose(file);
+    return data;
+}
+
+// File weight layout OHWI [F][H][W][C] -> bộ nhớ [H][W][C][F] như read_file_weight
+int16_t* read_weight_bin(const char* filename) {
+    tensor_header h;
+    int8_t* data = (int8_t*)tensor_load(filename, &h);
+    if (!data) return NULL;
+    int dims[4] = { -1, KERNEL_H, KERNEL_W, INPUT_C };
+    if (!tensor_check(filename, &h, TENSOR_I8, TENSOR_OHWI, 4, dims) || (int)h.dims[0] < OUTPUT_F) {
+        free(data);
+        return NULL;
+    }
+    int k_size = KERNEL_H * KERNEL_W * INPUT_C;
+    int16_t* weights = (int16_t*)malloc(k_size * OUTPUT_F * sizeof(int16_t));
+    for (int f = 0; f < OUTPUT_F; f++)
+        for (int k = 0; k < k_size; k++) weights[k * OUTPUT_F + f] = data[f * k_size + k];
+    free(data);
     return weights;
 }
 
@@ -140,8 +196,162 @@ int32_t* conv2d(int8_t* ifm, int16_t* weights) {
     return ofm_data;
 }
 
-// Hàm ghi file OFM
+// ENGINE IM2COL + GEMM
+// Hạ Conv2D thành GEMM: OFM[pixel][f] = sum_k IM2COL[pixel][k] * W[k][f]
+//   - k = (kh * KERNEL_W + kw) * INPUT_C + ci  -> trùng layout weight [H][W][C][F]
+//   - Mỗi lần chỉ dựng im2col cho CONV_GEMM_MC pixel (vừa L2), không dựng cả ma trận
+//   - IFM là NHWC nên mỗi (kh, kw) là INPUT_C byte liên tiếp -> memcpy, padding -> 0
+#define CONV_GEMM_MC 256  // Số pixel output mỗi khối im2col
+
+int32_t* conv2d_gemm(int8_t* ifm, int16_t* weights) {
+    int total_elements = OUTPUT_H * OUTPUT_W * OUTPUT_F;
+    int32_t* ofm_data = (int32_t*)malloc(total_elements * sizeof(int32_t));
+
+    int K = KERNEL_H * KERNEL_W * INPUT_C;
+    int M = OUTPUT_H * OUTPUT_W;
+
+    // Weight chuyển vị sang [F][K] dạng int8 (mỗi filter là 1 hàng liên tiếp)
+    int8_t* w_t = (int8_t*)malloc(OUTPUT_F * K);
+    // Khối im2col [CONV_GEMM_MC][K]
+    int8_t* col = (int8_t*)malloc(CONV_GEMM_MC * K);
+
+    if (!ofm_data || !w_t || !col) {
+        printf("Error: Memory allocation failed for GEMM engine\n");
+        exit(1);
+    }
+
+    for (int fo = 0; fo < OUTPUT_F; fo++)
+        for (int k = 0; k < K; k++)
+            w_t[fo * K + k] = (int8_t)weights[k * OUTPUT_F + fo];
+
+    for (int m0 = 0; m0 < M; m0 += CONV_GEMM_MC) {
+        int mc = (M - m0 < CONV_GEMM_MC) ? (M - m0) : CONV_GEMM_MC;
+
+        // Dựng khối im2col
+        for (int i = 0; i < mc; i++) {
+            int ho = (m0 + i) / OUTPUT_W;
+            int wo = (m0 + i) % OUTPUT_W;
+            int8_t* row = col + i * K;
+            for (int kh = 0; kh < KERNEL_H; kh++) {
+                int hi = ho * STRIDE + kh - PADDING;
+                for (int kw = 0; kw < KERNEL_W; kw++) {
+                    int wi = wo * STRIDE + kw - PADDING;
+                    int8_t* dst = row + (kh * KERNEL_W + kw) * INPUT_C;
+                    if (hi >= 0 && hi < INPUT_H && wi >= 0 && wi < INPUT_W) {
+                        memcpy(dst, ifm + hi * (INPUT_W * INPUT_C) + wi * INPUT_C, INPUT_C);
+                    } else {
+                        memset(dst, 0, INPUT_C);
+                    }
+                }
+            }
+        }
+
+        // GEMM: [mc x K] * [K x F] -> ghi thẳng vào OFM [ho][wo][fo]
+        gemm_i8_nt(mc, OUTPUT_F, K, col, K, w_t, K, ofm_data + m0 * OUTPUT_F, OUTPUT_F);
+    }
+
+    free(w_t);
+    free(col);
+    return ofm_data;
+}
+
+// ENGINE WINOGRAD F(m x m, 3 x 3), m = 2 hoặc 4 (chỉ cho kernel 3x3, stride 1)
+// Weight được biến đổi 1 lần: U[fo][ci] = G_s g G_s^T
+// Mỗi tile output m x m:
+//   - Đọc tile input alpha x alpha (alpha = m + 2) cho từng channel -> V = B^T d B
+//   - M = sum_ci U[fo][ci] .* V[ci]  (alpha^2 phép nhân / channel thay vì 9 * m^2)
+//   - Y = A^T M A / s^2  (chia hết, kết quả nguyên chính xác)
+int32_t* conv2d_winograd(int8_t* ifm, int16_t* weights, int m) {
+    const winograd_cfg* w = winograd_get(m);
+    if (!w || KERNEL_H != 3 || KERNEL_W != 3 || STRIDE != 1) {
+        printf("Error: Winograd only supports 3x3 kernel, stride 1, m = 2 or 4\n");
+        exit(1);
+    }
+    int a = w->alpha;
+    int aa = a * a;
+
+    int total_elements = OUTPUT_H * OUTPUT_W * OUTPUT_F;
+    int32_t* ofm_data = (int32_t*)malloc(total_elements * sizeof(int32_t));
+    int64_t* U = (int64_t*)malloc((size_t)OUTPUT_F * INPUT_C * aa * sizeof(int64_t));
+    int64_t* V = (int64_t*)malloc((size_t)INPUT_C * aa * sizeof(int64_t));
+
+    if (!ofm_data || !U || !V) {
+        printf("Error: Memory allocation failed for Winograd engine\n");
+        exit(1);
+    }
+
+    // Biến đổi weight [kh][kw][ci][fo] -> U[fo][ci][alpha][alpha]
+    for (int fo = 0; fo < OUTPUT_F; fo++) {
+        for (int ci = 0; ci < INPUT_C; ci++) {
+            int32_t g[9];
+            for (int kh = 0; kh < 3; kh++)
+                for (int kw = 0; kw < 3; kw++)
+                    g[kh * 3 + kw] = weights[kh * (KERNEL_W * INPUT_C * OUTPUT_F) +
+                                             kw * (INPUT_C * OUTPUT_F) + ci * OUTPUT_F + fo];
+            winograd_transform_weight(w, g, U + ((size_t)fo * INPUT_C + ci) * aa);
+        }
+    }
+
+    int tiles_h = (OUTPUT_H + m - 1) / m;
+    int tiles_w = (OUTPUT_W + m - 1) / m;
+
+    for (int th = 0; th < tiles_h; th++) {
+        for (int tw = 0; tw < tiles_w; tw++) {
+
+            // Biến đổi tile input của tất cả channel
+            for (int ci = 0; ci < INPUT_C; ci++) {
+                int32_t d[WINO_MAX_ALPHA * WINO_MAX_ALPHA];
+                for (int i = 0; i < a; i++) {
+                    int hi = th * m + i - PADDING;
+                    for (int j = 0; j < a; j++) {
+                        int wi = tw * m + j - PADDING;
+                        d[i * a + j] = (hi >= 0 && hi < INPUT_H && wi >= 0 && wi < INPUT_W)
+                                       ? ifm[hi * (INPUT_W * INPUT_C) + wi * INPUT_C + ci] : 0;
+                    }
+                }
+                winograd_transform_input(w, d, V + (size_t)ci * aa);
+            }
+
+            for (int fo = 0; fo < OUTPUT_F; fo++) {
+                // Nhân từng phần tử và cộng dồn theo channel
+                int64_t M[WINO_MAX_ALPHA * WINO_MAX_ALPHA] = {0};
+                const int64_t* u = U + (size_t)fo * INPUT_C * aa;
+                for (int ci = 0; ci < INPUT_C; ci++)
+                    for (int e = 0; e < aa; e++)
+                        M[e] += u[ci * aa + e] * V[ci * aa + e];
+
+                int64_t Y[4 * 4];
+                winograd_transform_output(w, M, Y);
+
+                // Ghi phần hợp lệ của tile (tile biên có thể vượt OUTPUT_H/W)
+                for (int i = 0; i < m; i++) {
+                    int ho = th * m + i;
+                    if (ho >= OUTPUT_H) break;
+                    for (int j = 0; j < m; j++) {
+                        int wo = tw * m + j;
+                        if (wo >= OUTPUT_W) break;
+                        ofm_data[ho * (OUTPUT_W * OUTPUT_F) + wo * OUTPUT_F + fo] = (int32_t)Y[i * m + j];
+                    }
+                }
+            }
+        }
+    }
+
+    free(U);
+    free(V);
+    return ofm_data;
+}
+
+// Hàm ghi file OFM (.npy: int32 shape (H, W, F))
 void write_ofm_file(const char* filename, int32_t* data) {
+    if (tensor_is_npy(filename)) {
+        int dims[3] = { OUTPUT_H, OUTPUT_W, OUTPUT_F };
+        if (tensor_save_npy(filename, TENSOR_I32, 3, dims, data) < 0) {
+            printf("Error: Cannot open file %s for writing\n", filename);
+            exit(1);
+        }
+        return;
+    }
     FILE* file = fopen(filename, "w");
     if (!file) {
         printf("Error: Cannot open file %s for writing\n", filename);
@@ -156,7 +366,19 @@ void write_ofm_file(const char* filename, int32_t* data) {
     fclose(file);
 }
 
-int main() {
+// Ghi OFM dạng tensor nhị phân (int32, NHWC, shape (H, W, F)) như ../ofm/ofm.bin của mô phỏng
+void write_ofm_bin(const char* filename, int32_t* data) {
+    int dims[3] = { OUTPUT_H, OUTPUT_W, OUTPUT_F };
+    tensor_header h = tensor_header_make(TENSOR_I32, TENSOR_NHWC, 3, dims);
+    if (tensor_save(filename, &h, data) < 0) {
+        printf("Error: Cannot open file %s for writing\n", filename);
+        exit(1);
+    }
+}
+
+// Usage: ./default [naive|gemm|wino2|wino4]   (mặc định: gemm)
+int main(int argc, char *argv[]) {
+    const char* engine = (argc > 1) ? argv[1] : "gemm";
     printf("Starting C convolution...\n");
     printf("Config: Input[%d,%d,%d], Kernel[%d,%d], Output[%d,%d,%d]\n", 
            INPUT_H, INPUT_W, INPUT_C, KERNEL_H, KERNEL_W, OUTPUT_H, OUTPUT_W, OUTPUT_F);
@@ -164,17 +386,30 @@ int main() {
     // Xóa file OFM cũ trước khi chạy
     remove("../ofm/ofm.txt");
 
-    // Đọc dữ liệu
-    int8_t* ifm_data = read_ifm_file("../params/ifm.txt");
-    int16_t* weight_data = read_file_weight("../params/weights.txt");
+    // Đọc dữ liệu (ưu tiên file nhị phân .bin, rồi .npy)
+    int8_t* ifm_data = read_ifm_bin("../params/ifm.bin");
+    if (!ifm_data) ifm_data = read_ifm_npy("../params/ifm.npy");
+    if (!ifm_data) ifm_data = read_ifm_file("../params/ifm.txt");
+    int16_t* weight_data = read_weight_bin("../params/weights.bin");
+    if (!weight_data) weight_data = read_weight_npy("../params/weights.npy");
+    if (!weight_data) weight_data = read_file_weight("../params/weights.txt");
 
     // Tính toán
-    printf("Computing...\n");
-    int32_t* ofm_data = conv2d(ifm_data, weight_data);
+    printf("Computing (%s)...\n", engine);
+    int32_t* ofm_data;
+    if (strcmp(engine, "naive") == 0)      ofm_data = conv2d(ifm_data, weight_data);
+    else if (strcmp(engine, "wino2") == 0) ofm_data = conv2d_winograd(ifm_data, weight_data, 2);
+    else if (strcmp(engine, "wino4") == 0) ofm_data = conv2d_winograd(ifm_data, weight_data, 4);
+    else                                   ofm_data = conv2d_gemm(ifm_data, weight_data);
 
     // Ghi file
     printf("Writing OFM...\n");
-    write_ofm_file("../ofm/ofm.txt", ofm_data);
+    // SIM_OFM_FORMAT như mô phỏng: txt (mặc định) / bin / npy / both, ghép được
+    int txt, bin, npy;
+    tensor_ofm_formats(&txt, &bin, &npy);
+    if (txt) write_ofm_file("../ofm/ofm.txt", ofm_data);
+    if (bin) write_ofm_bin("../ofm/ofm.bin", ofm_data);
+    if (npy) write_ofm_file("../ofm/ofm.npy", ofm_data);
 
     // Giải phóng
     free(ifm_data);
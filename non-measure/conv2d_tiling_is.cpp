@@ -3,6 +3,7 @@
 #include <stdint.h>
 #include <string.h>
 #include <math.h>
+#include "../common/pe_simd.h"
 
 // --- CẤU HÌNH BÀI TOÁN ---
 #define INPUT_H 112
@@ -173,15 +174,8 @@ void dma_load_weights_per_pixel(int pass_idx) {
 // COMPUTE ENGINE & CONTROLLER
 
 int32_t run_pe_array() {
-    int32_t partial_sum = 0;
-    for (int pe_id = 0; pe_id < NUM_PE; pe_id++) {
-        int base_idx = pe_id * MACS_PER_PE; 
-        int32_t pe_acc = 0; 
-        for (int k = 0; k < MACS_PER_PE; k++) {
-            pe_acc += (int32_t)buffer_ifm[base_idx + k] * (int32_t)buffer_weight[base_idx + k];
-        }
-        partial_sum += pe_acc;
-    }
+    // NUM_PE x MACS_PER_PE phép MAC được gom thành 1 tích vô hướng int8 (kernel SIMD)
+    int32_t partial_sum = pe_dot_i8(buffer_ifm, buffer_weight, NUM_PE * MACS_PER_PE);
     return partial_sum;
 }
 
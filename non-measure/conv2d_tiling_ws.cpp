@@ -2,6 +2,7 @@
 #include <stdlib.h>
 #include <stdint.h>
 #include <string.h>
+#include "../common/pe_simd.h"
 
 // --- CẤU HÌNH BÀI TOÁN ---
 #define INPUT_H 112
@@ -140,22 +141,8 @@ void dma_load_ifm(int ho, int wo, int pass_idx) {
 // COMPUTE ENGINE
 
 int32_t run_pe_array() {
-    int32_t partial_sum = 0;
-    
-    // 48 PE chạy song song
-    for (int pe_id = 0; pe_id < NUM_PE; pe_id++) {
-        int base_idx = pe_id * MACS_PER_PE; 
-        int32_t pe_acc = 0; 
-        
-        for (int k = 0; k < MACS_PER_PE; k++) {
-            // IFM lấy từ buffer IFM (mới load)
-            // Weight lấy từ buffer Weight (đã load từ trước và giữ nguyên)
-            int8_t a = buffer_ifm[base_idx + k];
-            int8_t b = buffer_weight[base_idx + k];
-            pe_acc += (int32_t)a * (int32_t)b;
-        }
-        partial_sum += pe_acc;
-    }
+    // NUM_PE x MACS_PER_PE phép MAC được gom thành 1 tích vô hướng int8 (kernel SIMD)
+    int32_t partial_sum = pe_dot_i8(buffer_ifm, buffer_weight, NUM_PE * MACS_PER_PE);
     
     return partial_sum;
 }
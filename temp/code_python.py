@@ -1,4 +1,6 @@
 def read_ifm_file(filename, shape):
+    if filename.endswith(".npy"):   # np.save / ofm.npy của mô phỏng: không cần parse text
+        return np.load(filename).astype(np.int32).reshape(shape)
     with open(filename, "r") as file:
         lines = file.readlines()    
     data = np.array([int(x.strip()) for x in lines], dtype=np.int32)
@@ -19,6 +21,8 @@ def read_ifm_file(filename, shape):
 
     return reshaped_data
 def read_file_weight(filename, shape):
+    if filename.endswith(".npy"):   # (H, W, C, F) = HWCF
+        return np.load(filename).astype(np.int16).reshape(shape)
     with open(filename, "r") as file:
         lines = file.readlines()    
     data = np.array([int(x.strip()) for x in lines], dtype=np.int16)
@@ -39,6 +43,9 @@ def read_file_weight(filename, shape):
     return reshaped_data
 
 def write_ofm_file(filename, data):
+    if filename.endswith(".npy"):
+        np.save(filename, np.rint(data).astype(np.int32))
+        return
     H, W, C = data.shape
     with open(filename, "w") as file:
         for h in range(H):          # Loop Channel trước (để khớp với genhex.py)
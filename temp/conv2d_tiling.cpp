@@ -2,6 +2,7 @@
 #include <stdlib.h>
 #include <stdint.h>
 #include <string.h>
+#include "../common/pe_simd.h"
 
 // --- CẤU HÌNH BÀI TOÁN ---
 #define INPUT_H 112
@@ -137,29 +138,8 @@ void dma_load_buffers(int ho, int wo, int pass_idx) {
 // - Tổng hợp kết quả của 48 PE lại ("Reduction tree" hoặc "Adder tree").
 
 int32_t run_pe_array() {
-    int32_t partial_sum_cycle = 0;
-
-    // Mô phỏng chạy song song 48 PE
-    for (int pe_id = 0; pe_id < NUM_PE; pe_id++) {
-        
-        // Xác định địa chỉ dữ liệu trong buffer mà PE này chịu trách nhiệm
-        // PE 0: index 0,1,2
-        // PE 1: index 3,4,5
-        // ...
-        int base_idx = pe_id * MACS_PER_PE; 
-
-        int32_t pe_acc = 0; // Thanh ghi accumulator bên trong PE
-
-        // PE thực hiện 3 phép MAC
-        for (int k = 0; k < MACS_PER_PE; k++) {
-            int8_t a = buffer_ifm[base_idx + k];
-            int8_t b = buffer_weight[base_idx + k];
-            pe_acc += (int32_t)a * (int32_t)b;
-        }
-
-        // Sau khi PE tính xong, kết quả được gom lại (Adder Tree)
-        partial_sum_cycle += pe_acc;
-    }
+    // NUM_PE x MACS_PER_PE phép MAC được gom thành 1 tích vô hướng int8 (kernel SIMD)
+    int32_t partial_sum_cycle = pe_dot_i8(buffer_ifm, buffer_weight, NUM_PE * MACS_PER_PE);
 
     return partial_sum_cycle;
 }
@@ -3,6 +3,7 @@
 #include <stdint.h>
 #include <string.h>
 #include <math.h>
+#include "../common/pe_simd.h"
 
 // --- CẤU HÌNH BÀI TOÁN ---
 // Kích thước Input Feature Map (IFM): 112x112, 32 channels
@@ -168,18 +169,8 @@ void dma_load_weights_per_pixel(int pass_idx) {
 
 // Mô phỏng mảng PE thực hiện phép nhân chập (Dot Product)
 int32_t run_pe_array() {
-    int32_t partial_sum = 0;
-    // Duyệt qua các PE (Mỗi PE xử lý một phần của phép tính)
-    for (int pe_id = 0; pe_id < NUM_PE; pe_id++) {
-        int base_idx = pe_id * MACS_PER_PE; 
-        int32_t pe_acc = 0; 
-        // Thực hiện MAC (Multiply-Accumulate)
-        for (int k = 0; k < MACS_PER_PE; k++) {
-            // Lấy dữ liệu từ buffer IFM và Weight để nhân
-            pe_acc += (int32_t)buffer_ifm[base_idx + k] * (int32_t)buffer_weight[base_idx + k];
-        }
-        partial_sum += pe_acc;
-    }
+    // NUM_PE x MACS_PER_PE phép MAC được gom thành 1 tích vô hướng int8 (kernel SIMD)
+    int32_t partial_sum = pe_dot_i8(buffer_ifm, buffer_weight, NUM_PE * MACS_PER_PE);
     // Cộng thêm thời gian tính toán vào tổng chu kỳ
     total_compute_cycles += PE_COMPUTE_CYCLES;
     return partial_sum;
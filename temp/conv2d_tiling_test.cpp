@@ -3,6 +3,7 @@
 #include <stdint.h>
 #include <string.h>
 #include <math.h>
+#include "../common/pe_simd.h"
 
 // --- CẤU HÌNH BÀI TOÁN (PROBLEM CONFIG) ---
 // Định nghĩa kích thước của Input Feature Map (IFM) và Kernel
@@ -159,22 +160,8 @@ int dma_load_buffers(int ho, int wo, int pass_idx) {
 // Hàm này mô phỏng mảng PE thực hiện phép nhân chập trên dữ liệu đã có trong Buffer
 // Output: Kết quả tính toán (Partial Sum) và trả về số cycle tiêu tốn qua con trỏ cycles_taken
 int32_t run_pe_array(int* cycles_taken) {
-    int32_t partial_sum = 0;
-
-    // --- Logic tính toán chức năng (Functional Simulation) ---
-    // Duyệt qua các PE (mỗi PE chịu trách nhiệm một phần công việc)
-    for (int pe_id = 0; pe_id < NUM_PE; pe_id++) {
-        int base_idx = pe_id * MACS_PER_PE; 
-        int32_t pe_acc = 0; 
-        // Mỗi PE thực hiện MACS_PER_PE phép nhân cộng
-        for (int k = 0; k < MACS_PER_PE; k++) { 
-            // Lấy dữ liệu từ buffer (SRAM) - truy cập cực nhanh
-            int8_t a = buffer_ifm[base_idx + k];
-            int8_t b = buffer_weight[base_idx + k];
-            pe_acc += (int32_t)a * (int32_t)b; // MAC: Multiply-Accumulate
-        }
-        partial_sum += pe_acc; // Cộng dồn kết quả từ các PE
-    }
+    // NUM_PE x MACS_PER_PE phép MAC được gom thành 1 tích vô hướng int8 (kernel SIMD)
+    int32_t partial_sum = pe_dot_i8(buffer_ifm, buffer_weight, NUM_PE * MACS_PER_PE);
 
     // --- TÍNH TOÁN LATENCY ---
     // Vì các PE chạy song song (Parallel), thời gian thực thi chỉ tính bằng thời gian của 1 PE
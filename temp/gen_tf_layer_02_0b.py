@@ -200,4 +200,10 @@ if __name__ == "__main__":
     output_data = model.predict(input_data_padded.reshape(1, padded_height, padded_width, args.ifm_channel).astype(np.float32))
     output_data = output_data.reshape(output_feature_height, output_feature_width, output_feature_channel)
     write_hex_file(output_file, output_data)
-    print(f"Kết quả raw Conv2D đã được ghi vào {output_file}")
\ No newline at end of file
+    print(f"Kết quả raw Conv2D đã được ghi vào {output_file}")
+
+    # Bản .npy cho mô phỏng C++ (common/tensor_io.h đọc / ghi .npy trực tiếp, không qua text):
+    # IFM (H, W, C) int8, Weight (3, 3, C, F) = HWCF int8, OFM (OH, OW, F) int32
+    np.save("../params/ifm.npy", input_data.astype(np.int8))
+    np.save("../params/weights.npy", weight_data.astype(np.int8))
+    np.save(output_file.replace(".hex", ".npy"), np.rint(output_data).astype(np.int32))
\ No newline at end of file